@@ -16,8 +16,26 @@
 #include <array>
 #include <fstream>
 #include <exception>
+#include <algorithm>
+#include <tuple>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cctype>
+#include <mutex>
+#include <condition_variable>
+#include <bitset>
+
+// the vector scans are built for x86 whatever the compiler targets, and picked at run time
+#if (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define aa_x86_vectors 1
+#include <immintrin.h>
+#endif
 
 #include "genparser.hpp"
+#include "mapfile.hpp"
 
 using namespace std;
 
@@ -28,7 +46,26 @@ namespace aa {
 	
 /*/// ================================================================================================================================
 	Productions is a second low level AST. Very simple. It's basically runs of strings and closest to plain old BNF
+	
+	Each symbol is a word. V is a var, T a byte, R a range of bytes and C a choice of them, each byte as four hex digits.
+	U is a list of code point ranges, six hex digits an end, which compile turns into rules over UTF-8.
 /*/// --------------------------------------------------------------------------------------------------------------------------------
+	// n hex digits of a word from at
+	uint32_t hex_at (const std::string& w, size_t at, size_t n = 4) {
+		uint32_t v = 0;
+		for (size_t i = at; i != at + n && i < w.size(); ++i) {
+			auto c = (uint8_t) w[i];
+			v = v * 16 + (isdigit (c) ? c - '0' : tolower (c) - 'a' + 10);
+		}
+		return v;
+	}
+	
+	std::string range_word (uint32_t min, uint32_t max) {
+		std::stringstream ss;
+		ss << "R" << hex << setfill('0') << setw(4) << min << setw(4) << max;
+		return ss.str();
+	}
+	
 	struct prod {
 		std::string lhs;
 		strings     rhs;
@@ -70,16 +107,29 @@ namespace aa {
 			{	auto t = at->as (aChoose);
 				if (t != nullptr) {
 					std::stringstream ss;
-					ss << "C" << setfill('0') << setw(4) << hex;
-					for (auto c : t->chars) { ss << (int)c; }
+					if (std::all_of (t->chars.begin(), t->chars.end(), [](char32_t c) { return c <= 0xff; })) {
+						ss << "C" << hex << setfill('0');
+						for (auto c : t->chars) { ss << setw(4) << (uint32_t)c; }
+					}
+					else {
+						// code points next to each other make one range
+						auto cs = t->chars;
+						std::sort (cs.begin(), cs.end());
+						ss << "U" << hex << setfill('0');
+						for (size_t i = 0, j = 0; i != cs.size(); i = j) {
+							for (j = i + 1; j != cs.size() && cs[j] <= cs[j-1] + 1; ++j) { }
+							ss << setw(6) << (uint32_t)cs[i] << setw(6) << (uint32_t)cs[j-1];
+						}
+					}
 					rhs .emplace_back (ss.str());
 					return;
 				} }
 			
 			{	auto t = at->as (aRange);
 				if (t != nullptr) {
+					if (t->max <= 0xff) { rhs .emplace_back (range_word (t->min, t->max)); return; }
 					std::stringstream ss;
-					ss << "R" << setfill('0') << setw(4) << hex << t->min << t->max;
+					ss << "U" << hex << setfill('0') << setw(6) << (uint32_t)t->min << setw(6) << (uint32_t)t->max;
 					rhs .emplace_back (ss.str());
 					return;
 				} }
@@ -99,7 +149,7 @@ namespace aa {
 			out << i.lhs << "\t\t\t\t->";
 			for (auto& j : i.rhs) {
 				out << " ";
-				if (j[0] == 'V') { std::string v (j.begin()+1, j.end()); out << v; }
+				if (j[0] == 'V' || j[0] == 'K') { std::string v (j.begin()+1, j.end()); out << v; }
 				else
 				if (j[0] == 'T') { std::string v (j.begin()+1, j.end()); out << "\'" << v << "\'"; }
 				else
@@ -108,7 +158,7 @@ namespace aa {
 					auto num = j.size() / 4;
 					for (auto i = 0; i != num; ++i) {
 						if (i) out << ",";
-						out << j[i*4] << j[i*4+1] << j[i*4+2] << j[i*4+3];
+						out << j[1+i*4] << j[2+i*4] << j[3+i*4] << j[4+i*4];
 					}
 					out << "]";
 				}
@@ -185,6 +235,83 @@ namespace aa {
 		return s[0] != 'V' && s[0] != 'E';
 	}
 
+/*/// ================================================================================================================================
+	Code Points
+	
+	The action table has a column per byte, so a range or choice that goes past 0xff is taken as Unicode code points
+	and parsed straight from their UTF-8. One that stays within a byte is bytes, as OCTET needs. Each code point
+	terminal becomes a helper rule named for its ranges, with a production for each run of byte ranges its UTF-8 takes.
+	
+	The runs are the fewest that cover the code points. A range is split where the encoded length changes, then
+	wherever a continuation byte would not span 80-bf, until lo and hi differ only in bytes that span them. Surrogates
+	are left out. Productions with the same lead bytes share their states in the table, so the result is the
+	automaton a decoder would be, run with no decode pass.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	using byteranges = std::vector <std::pair <uint8_t, uint8_t>>;
+	
+	size_t utf8_encode (uint32_t c, uint8_t* out) {
+		if (c < 0x80)    { out[0] = c; return 1; }
+		if (c < 0x800)   { out[0] = 0xc0 | (c >> 6); out[1] = 0x80 | (c & 0x3f); return 2; }
+		if (c < 0x10000) { out[0] = 0xe0 | (c >> 12); out[1] = 0x80 | ((c >> 6) & 0x3f); out[2] = 0x80 | (c & 0x3f); return 3; }
+		out[0] = 0xf0 | (c >> 18); out[1] = 0x80 | ((c >> 12) & 0x3f); out[2] = 0x80 | ((c >> 6) & 0x3f); out[3] = 0x80 | (c & 0x3f);
+		return 4;
+	}
+	
+	// the runs of byte ranges the UTF-8 of lo through hi takes
+	void utf8_split (uint32_t lo, uint32_t hi, std::vector <byteranges>& out) {
+		hi = std::min (hi, 0x10ffffu);
+		if (lo > hi) return;
+		if (lo <= 0xdfff && hi >= 0xd800) {
+			if (lo < 0xd800) utf8_split (lo, 0xd7ff, out);
+			if (hi > 0xdfff) utf8_split (0xe000, hi, out);
+			return;
+		}
+		for (uint32_t edge : { 0x7fu, 0x7ffu, 0xffffu }) {
+			if (lo <= edge && edge < hi) { utf8_split (lo, edge, out); utf8_split (edge + 1, hi, out); return; }
+		}
+		
+		uint8_t a[4], b[4];
+		auto n = utf8_encode (lo, a);
+		utf8_encode (hi, b);
+		for (size_t i = 1; i != n; ++i) {
+			uint32_t m = (1u << (6 * i)) - 1;
+			if ((lo & ~m) == (hi & ~m)) continue;
+			if ((lo & m) != 0) { utf8_split (lo, lo | m, out); utf8_split ((lo | m) + 1, hi, out); return; }
+			if ((hi & m) != m) { utf8_split (lo, (hi & ~m) - 1, out); utf8_split (hi & ~m, hi, out); return; }
+		}
+		
+		byteranges run;
+		for (size_t i = 0; i != n; ++i) { run .push_back ({ a[i], b[i] }); }
+		out .push_back (run);
+	}
+	
+	// replace the U words with helper rules. they go after the rest, so the productions keep their ids, and their names
+	// sort after every rule's and before the start's
+	void expand_code_points (prods& ps, idmap& ids) {
+		std::set <std::string> words;
+		for (auto& p : ps) {
+			for (auto& w : p.rhs) {
+				if (w[0] != 'U') continue;
+				words .insert (w);
+				w = "V~" + w.substr (1);
+			}
+		}
+		
+		auto col = (uint32_t) (256 + ids.size());
+		for (auto& w : words) {
+			std::vector <byteranges> runs;
+			for (size_t i = 1; i + 12 <= w.size(); i += 12) { utf8_split (hex_at (w, i, 6), hex_at (w, i + 6, 6), runs); }
+			
+			auto name = "~" + w.substr (1);
+			ids ["V" + name] = col++;
+			for (auto& r : runs) {
+				ps .emplace_back (prod (name));
+				ps.back().id = (uint32_t) ps.size() - 1;
+				for (auto& b : r) { ps.back().rhs .push_back (range_word (b.first, b.second)); }
+			}
+		}
+	}
+
 /*/// ================================================================================================================================
 	ABNF predefines some symbols.
 /*/// --------------------------------------------------------------------------------------------------------------------------------
@@ -202,7 +329,7 @@ namespace aa {
 	
 	Not all that efficient, but it doesn't need to be.
 /*/// --------------------------------------------------------------------------------------------------------------------------------
-	mapsets calculate_first_sets (prods& is) {
+	mapsets calculate_first_sets (prods& is, bool verbose) {
 		mapsets ms;
 		
 		// initialize with builtins
@@ -239,7 +366,7 @@ namespace aa {
 			}
 		}
 		
-		cout << "** done in " << pass << " passes.\n";
+		if (verbose) { cout << "** done in " << pass << " passes.\n"; }
 		return ms;
 	}
 	
@@ -370,7 +497,7 @@ namespace aa {
 	symbols emptysyms;
 	
 	void print_word (std::ostream& out, const std::string& w) {
-		if (w[0] == 'V') { std::string v (w.begin()+1, w.end()); out << v; }
+		if (w[0] == 'V' || w[0] == 'K') { std::string v (w.begin()+1, w.end()); out << v; }
 		else
 		if (w[0] == 'T') { std::string v (w.begin()+1, w.end()); out << "\'" << v << "\'"; }
 		else
@@ -379,7 +506,7 @@ namespace aa {
 			auto num = w.size() / 4;
 			for (auto i = 0; i != num; ++i) {
 				if (i) out << ",";
-				out << w[i*4] << w[i*4+1] << w[i*4+2] << w[i*4+3];
+				out << w[1+i*4] << w[2+i*4] << w[3+i*4] << w[4+i*4];
 			}
 			out << "]";
 		}
@@ -427,7 +554,7 @@ namespace aa {
 		return out;
 	}
 
-	bool compute_one_closure (itemset& is, mapsets& first, prods& ps) {
+	bool compute_one_closure (itemset& is, mapsets& first, prods& ps, bool verbose) {
 		if (is.empty()) return false;
 		
 		item& i = is.front();
@@ -463,7 +590,7 @@ namespace aa {
 				}
 			}
 		}
-		cout << is << "\n\n\n";
+		if (verbose) { cout << is << "\n\n\n"; }
 		return true;
 	}
 	
@@ -473,7 +600,7 @@ namespace aa {
 		size_t id;  // the goto id we want to send to the back ref
 	};
 
-	void compute_all_closures (item& init, itemlist& its, mapsets& first, prods& ps) {
+	void compute_all_closures (item& init, itemlist& its, mapsets& first, prods& ps, bool verbose) {
 		std::deque <size_t> work;
 		std::set <item> completed;
 		
@@ -488,7 +615,7 @@ namespace aa {
 
 			auto& is = its[index];
 			
-			if (compute_one_closure (is, first, ps)) {
+			if (compute_one_closure (is, first, ps, verbose)) {
 				for (auto& r : is) {
 					auto next = item {r.src, r.dot + 1, r.la, 0, true }; // go index will be properly set later
 					uint32_t newi = its.size(); // new index
@@ -521,15 +648,15 @@ namespace aa {
 			}
 		}
 		
-		cout << "\n\n--- cleanup phase\n";
+		if (verbose) { cout << "\n\n--- cleanup phase\n"; }
 		// final pass. use the completed list to do final fix up
 		for (auto& is : its) {
 			for (auto& it : is) {
 				if (it.go == 0 && it.dot < it.src->rhs.size()) {
-					cout << "searching for" << it << "\n";
+					if (verbose) { cout << "searching for" << it << "\n"; }
 					auto f = completed.find (it);
 					if (f != completed.end()) {
-						cout << "found with goto of " << f->go << "\n";
+						if (verbose) { cout << "found with goto of " << f->go << "\n"; }
 						it.go = f->go;
 					}
 					else {
@@ -542,7 +669,7 @@ namespace aa {
 
 	symbols s_end = { "E\xff" };
 	
-	itemlist create_closures (prods& ps, mapsets& first) {
+	itemlist create_closures (prods& ps, mapsets& first, bool verbose) {
 		ps .emplace_back (prod ("~S~"));
 		ps .back().rhs.push_back ("Vstart");
 		
@@ -551,7 +678,7 @@ namespace aa {
 		
 		auto it = item { &ps.back(), 0, &s_end, 0, true };
 
-		compute_all_closures (it, its, first, ps);
+		compute_all_closures (it, its, first, ps, verbose);
 		
 		return its;
 	}
@@ -561,6 +688,12 @@ namespace aa {
 		uint32_t op:4;  // 0 = error, 1 = shift, 2 = reduce, 3 = go, 4 = multi, 5 = accept
 	};
 	
+	inline bool operator== (const action& a, const action& b) { return a.op == b.op && a.target == b.target; }
+	inline bool operator!= (const action& a, const action& b) { return !(a == b); }
+	
+	inline uint32_t packed (action a) { return (uint32_t (a.target) << 4) | a.op; }
+	inline action unpacked (uint32_t p) { return action { p >> 4, p & 0xf }; }
+	
 	std::ostream& operator<< (std::ostream& out, const action& a) {
 		switch (a.op) {
 			case 0: cout << "Err"; break;
@@ -599,31 +732,140 @@ namespace aa {
 	using prodinfo = std::pair<uint32_t, uint32_t>;
 	using prodinfos = std::vector <prodinfo>;
 	
+	using bytes = std::bitset <256>;
+	
+	// the bytes a terminal stands for, read the way the action table reads them
+	bytes bytes_of (const std::string& w) {
+		bytes b;
+		if (w[0] == 'T') { b .set ((uint8_t) w[1]); }
+		else
+		if (w[0] == 'R') {
+			for (auto i = hex_at (w, 1); i <= hex_at (w, 5) && i < 256; ++i) b .set (i);
+		}
+		else
+		if (w[0] == 'C') {
+			for (size_t i = 0; i != w.size()/4; ++i) {
+				auto ch = hex_at (w, 1+i*4);
+				if (ch < 256) b .set (ch);
+			}
+		}
+		return b;
+	}
+	
 /*/// ================================================================================================================================
 	Action Table
 	
 	Conflicts are allowed. The driver will spawn new workers (at the expense of memory and time) to work it out.
+	
+	A unit production, one var on its right, can be folded into the goto that exposed it: the goto's state does nothing
+	on the lookahead but reduce it, so the driver goes on to the next goto from the same node below instead. Not where
+	unit rules go round in a cycle, there only the merging of the stacks stops the chain.
+	
+	The rows are mostly errors, so they are kept packed. Each row has a default, the action most of its bytes take, and
+	only the columns that differ from it are stored. The rows are laid over one another in a single run of cells, each
+	shifted to a base where its cells land on free ones, and a cell records whose it is. A read that finds some other
+	state's cell, or none, gets the default, or an error for a var. The fullest rows are placed first.
+	
+	Bytes that no terminal tells apart act the same in every state, so a row has one column per class of them rather
+	than per byte, then the vars. colof takes a column, byte or var, to where it is in a row. The driver looks its
+	lookahead up once a step.
+	
+	The cells are in two sections, one run after the other. The actions on bytes come first, the gotos on vars after,
+	each row split in two and packed in its own section with its own base. A goto is read straight by its var.
+	
+	Every array the driver reads is flat, so a table can also be read in place from a file mapped into memory. A table
+	that was built owns its arrays, one that was mapped only points into the file.
 /*/// --------------------------------------------------------------------------------------------------------------------------------
+	struct combcell {
+		uint32_t state;  // whose cell it is
+		action   act;
+	};
+	
+	const uint32_t nostate = ~0u;
+	
+	// an array a table owns, or one it reads in place
+	template <typename T>
+	struct flat {
+		std::vector <T> own;     // while the table is built
+		const T*        at = nullptr;
+		size_t          count = 0;
+		
+		inline const T& operator[] (size_t i) const { return at[i]; }
+		inline size_t   size () const  { return count; }
+		inline bool     empty () const { return count == 0; }
+		inline const T* begin () const { return at; }
+		inline const T* end () const   { return at + count; }
+		
+		// built, reads go to own from now on
+		void fix () { at = own.data(); count = own.size(); }
+		void view (const T* p, size_t n) { own .clear (); at = p; count = n; }
+	};
+	
+	// every conflict list end to end. a list runs from where it starts to where the next one does
+	struct conflictlists {
+		flat <uint32_t> starts;   // one more than there are lists
+		flat <action>   all;
+		
+		struct list {
+			const action* b;
+			const action* e;
+			inline const action* begin () const { return b; }
+			inline const action* end () const   { return e; }
+			inline size_t        size () const  { return e - b; }
+		};
+		
+		inline list   operator[] (size_t i) const { return list { all.begin() + starts[i], all.begin() + starts[i+1] }; }
+		inline size_t size () const { return starts.empty() ? 0 : starts.size() - 1; }
+		
+		void fix (const conflictset& cs) {
+			starts.own .assign (1, 0);
+			for (auto& cl : cs) {
+				all.own .insert (all.own.end(), cl.begin(), cl.end());
+				starts.own .push_back ((uint32_t) all.own.size());
+			}
+			starts .fix (); all .fix ();
+		}
+	};
+	
 	struct actionfsm {
-		actiontable  actions;   // each row is a state, one row per itemset
-		conflictset  conflicts; // overflow area for when a state has more than one action for a transition
+		flat <combcell> cells;     // every row's actions but its defaults, each row shifted to its base
+		flat <uint32_t> base;      // per state, where its actions on the classes start in cells. one row per itemset
+		flat <uint32_t> gobase;    // per state, where its gotos start in cells, past every action
+		flat <action>   defaults;  // per state, its action on a byte not in cells
+		flat <uint32_t> colof;     // per column, where it is in a row. bytes by class, then the vars
+		size_t       classes = 0;  // classes of bytes
+		size_t       width = 0;    // columns of a row, the classes then the vars
+		conflictlists conflicts;   // overflow area for when a state has more than one action for a transition
+		conflictset  lists;        // the same, while the rows are built
 		size_t       columns;   // terminals + vars
-		prodinfos    pdata;     // number of elemnets to pop and what var to trampolline thru
+		flat <prodinfo> pdata;     // number of elemnets to pop and what var to trampolline thru
 		prods&       prs;       // size info
 		idmap&       vars;      // map name to column
 		strings      errinfo;  // the item desired but not found
+		flat <std::bitset <256>> expects; // per state, the bytes it has an action for. what a dead thread wanted
+		flat <uint8_t>  folds;     // per production, 1 when its reduction can be folded into a goto
 		
-		actionfsm (itemlist& il, prods& ps, idmap& ids) : actions (il.size()), columns (256 + ids.size()), prs (ps), vars (ids) {
+		// an empty table, for one read from a file
+		actionfsm (prods& ps, idmap& ids) : columns (256), prs (ps), vars (ids) { }
 		
-			pdata.reserve (prs.size());
+		actionfsm (itemlist& il, prods& ps, idmap& ids, bool verbose) : columns (256 + ids.size()), prs (ps), vars (ids) {
+		
+			group_bytes ();
+			
+			pdata.own .reserve (prs.size());
 			for (auto& p : prs) {
-				pdata .push_back ({ p.rhs.size(), ids[p.lhs] });
+				pdata.own .push_back ({ p.rhs.size(), ids[p.lhs] });
 			}
 		
 			errinfo .resize (il.size());
+			expects.own .resize (il.size());
+			defaults.own .resize (il.size());
 			
+			std::vector <sparserow> sparse (il.size());
+			actionrow row;
+			auto eos = colof [0xff];
 			for (size_t i = 0; i != il.size(); ++i) {
-				auto& row = actions[i];
+				row .clear();
 				prepare_row (row);
 				
 				for (auto& it : il[i]) {
@@ -641,7 +883,7 @@ namespace aa {
 							errinfo[i] = ss.str();
 						}
 						
-						cout << "at " << i << " seek " << errinfo[i] << "\n";
+						if (verbose) { cout << "at " << i << " seek " << errinfo[i] << "\n"; }
 					}
 					
 					if (it.go != 0) { // somewhere inside a production
@@ -650,6 +892,8 @@ namespace aa {
 							if (v[0] == 'R')  { setrange (row, v, 1, it.go); }
 							else
 							if (v[0] == 'C')  { setchoices (row, v, 1, it.go); }
+							else
+							if (v[0] == 'K')  { setitem (row, token_column (v), 1, it.go); }
 							else              { setitem (row, v[1], 1, it.go); }
 						}
 						else {
@@ -663,40 +907,114 @@ namespace aa {
 								else
 								if (f[0] == 'C') { setchoices (row, f, 2, (uint32_t)it.src->id); }
 								else
-								if (f[0] == 'E') { row[255].op = 2; row[255].target = (uint32_t)it.src->id; }
+								if (f[0] == 'E') { row[eos].op = 2; row[eos].target = (uint32_t)it.src->id; }
+								else
+								if (f[0] == 'K') { setitem (row, token_column (f), 2, (uint32_t)it.src->id); }
 								else             { setitem (row, f[1], 2, (uint32_t)it.src->id); }
 							}
 						}
 						else {
-							row [255].op = 5; row[255].target = 0;
+							row [eos].op = 5; row[eos].target = 0;
 						}
 
 					}
 				}
+				
+				for (size_t c = 0; c != 256; ++c) { if (row [colof [c]].op != 0) expects.own[i] .set (c); }
+				sparse[i] = squeeze (row, defaults.own[i]);
+			}
+			
+			// the gotos are split off, they go in their own section
+			std::vector <sparserow> gotos (il.size());
+			for (size_t i = 0; i != il.size(); ++i) {
+				auto split = std::find_if (sparse[i].begin(), sparse[i].end(), [&](const std::pair <uint32_t, action>& e) { return e.first >= classes; });
+				for (auto e = split; e != sparse[i].end(); ++e) { gotos[i] .push_back ({ uint32_t (e->first - classes), e->second }); }
+				sparse[i] .erase (split, sparse[i].end());
+			}
+			pack (sparse, base.own, 0, classes);
+			pack (gotos, gobase.own, cells.own.size(), columns - 256);
+			
+			// a var reaches another through a unit production. the ones that reach themselves aren't folded
+			std::map <std::string, symbols> units;
+			for (auto& p : prs) {
+				if (p.rhs.size() == 1 && p.rhs[0][0] == 'V') units [p.lhs] .insert (p.rhs[0]);
+			}
+			folds.own .resize (prs.size());
+			for (size_t i = 0; i != prs.size(); ++i) {
+				auto& p = prs[i];
+				if (p.rhs.size() != 1 || p.rhs[0][0] != 'V' || p.lhs == "V~S~") continue;
+				symbols seen;
+				strings todo = { p.lhs };
+				bool cycle = false;
+				while (!todo.empty() && !cycle) {
+					auto v = todo.back(); todo .pop_back();
+					for (auto& u : units [v]) {
+						if (u == p.lhs) cycle = true;
+						if (seen.insert (u).second) todo .push_back (u);
+					}
+				}
+				folds.own[i] = !cycle;
 			}
+			
+			cells .fix (); base .fix (); gobase .fix (); defaults .fix ();
+			pdata .fix (); expects .fix (); folds .fix ();
+			conflicts .fix (lists);
+			lists .clear ();
+		}
+		
+		inline size_t states () const { return base.size(); }
+		
+		// by the column of a row
+		inline action at (size_t state, uint32_t k) const {
+			if (k >= classes) return go (state, k - classes + 256);
+			auto& c = cells [base [state] + k];
+			return c.state == state ? c.act : defaults [state];
+		}
+		
+		// the goto on a var, by its column
+		inline action go (size_t state, size_t col) const {
+			auto& c = cells [gobase [state] + col - 256];
+			return c.state == state ? c.act : action ();
 		}
 		
-		void setitem (actionrow& r, size_t i, short op, uint32_t target) {
+		inline action act (size_t state, size_t col) const { return col < 256 ? at (state, colof [col]) : go (state, col); }
+		
+		// a whole row, for what reads a table rather than runs it
+		actionrow row (size_t state) const {
+			actionrow r (columns);
+			for (size_t c = 0; c != columns; ++c) { r[c] = act (state, c); }
+			return r;
+		}
+		
+		// a token is shifted in the column of its rule, which nothing ever reduces to
+		size_t token_column (const std::string& k) { return vars ["V" + k.substr (1)]; }
+		
+		// by the column, byte or var. the row is the packed one
+		void setitem (actionrow& r, size_t col, short op, uint32_t target) {
+			auto i = colof [col];
+			auto act = action { target, (uint32_t) op };
 			if (r[i].op == 0) {
-				r[i].op = op;
-				r[i].target = target;
+				r[i] = act;
 			}
 			else
 			if (r[i].op == 4) {
-				conflicts[r[i].target].push_back (action { target, (uint32_t) op });
+				auto& cl = lists[r[i].target];
+				if (std::find (cl.begin(), cl.end(), act) == cl.end()) { cl .push_back (act); }
 			}
-			else {
-				uint32_t target = (uint32_t) conflicts.size();
-				conflicts.emplace_back (conflictlist());
-				conflicts.back().push_back (r[i]);
+			else
+			if (r[i] != act) { // keep both, the driver takes every path
+				uint32_t at = (uint32_t) lists.size();
+				lists.emplace_back (conflictlist());
+				lists.back().push_back (r[i]);
+				lists.back().push_back (act);
 				r[i].op = 4;
-				r[i].target = target;
+				r[i].target = at;
 			}
 		}
 		
 		void setrange (actionrow& r, const std::string& v, short op, uint32_t target) {
-			size_t min = (v[1]-'0')*0x1000 + (v[2]-'0')*0x0100 + (v[3]-'0')*0x0010 + (v[4]-'0');
-			size_t max = (v[5]-'0')*0x1000 + (v[6]-'0')*0x0100 + (v[7]-'0')*0x0010 + (v[8]-'0');
+			size_t min = hex_at (v, 1);
+			size_t max = std::min (hex_at (v, 5), 0xffu);
 			
 			for (auto i = min; i <= max; ++i) {
 				setitem (r, i, op, target);
@@ -705,14 +1023,110 @@ namespace aa {
 
 		void setchoices (actionrow& r, const std::string& v, short op, uint32_t target) {
 			for (int i = 0; i != v.size()/4; ++i) {
-				size_t ch = (v[1+i*4]-'0')*0x1000 + (v[2+i*4]-'0')*0x0100 + (v[3+i*4]-'0')*0x0010 + (v[4+i*4]-'0');
-				setitem (r, ch, op, target);
+				size_t ch = hex_at (v, 1+i*4);
+				if (ch <= 0xff) setitem (r, ch, op, target);
 			}
 		}
 
 		void prepare_row (actionrow& r) {
 			// memset (&r, sizeof (actionrow), 0);
-			r .resize (columns);
+			r .resize (width);
+		}
+		
+		// split the bytes wherever some terminal, or the end of the input, takes one and not the other
+		void group_bytes () {
+			std::set <std::string> terms;
+			for (auto& p : prs) {
+				for (auto& w : p.rhs) { if (w[0] == 'T' || w[0] == 'R' || w[0] == 'C') terms .insert (w); }
+			}
+			
+			std::vector <uint32_t> cls (256, 0);
+			auto split = [&](const bytes& b) {
+				std::map <std::pair <uint32_t, bool>, uint32_t> into;
+				for (size_t c = 0; c != 256; ++c) {
+					auto k = std::make_pair (cls[c], (bool) b[c]);
+					auto f = into .find (k);
+					cls[c] = f != into.end() ? f->second : (into [k] = (uint32_t) into.size());
+				}
+			};
+			for (auto& t : terms) { split (bytes_of (t)); }
+			split (bytes () .set (0xff));
+			
+			classes = 1 + *std::max_element (cls.begin(), cls.end());
+			width = classes + columns - 256;
+			colof.own .resize (columns);
+			for (size_t c = 0; c != columns; ++c) { colof.own[c] = c < 256 ? cls[c] : uint32_t (c - 256 + classes); }
+			colof .fix ();
+		}
+		
+		using sparserow = std::vector <std::pair <uint32_t, action>>;
+		
+		// the columns of a row that its default doesn't cover. the default is the action most classes take, error on a tie
+		sparserow squeeze (const actionrow& by, action& def) {
+			std::map <uint32_t, size_t> counts;
+			for (size_t k = 0; k != classes; ++k) { ++counts [packed (by[k])]; }
+			size_t most = 0;
+			for (auto& n : counts) {
+				if (n.second > most) { most = n.second; def = unpacked (n.first); }
+			}
+			
+			sparserow sr;
+			for (size_t k = 0; k != by.size(); ++k) {
+				if (by[k] != (k < classes ? def : action ())) sr .push_back ({ (uint32_t) k, by[k] });
+			}
+			return sr;
+		}
+		
+		// lay rows span columns wide over one another from cell from on, fullest first, each at the first base where its
+		// cells are all free
+		void pack (const std::vector <sparserow>& sparse, std::vector <uint32_t>& bases, size_t from, size_t span) {
+			std::vector <uint32_t> order (sparse.size());
+			for (uint32_t i = 0; i != order.size(); ++i) order[i] = i;
+			std::stable_sort (order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sparse[a].size() > sparse[b].size(); });
+			
+			auto& run = cells.own;
+			bases .assign (sparse.size(), (uint32_t) from);
+			size_t lowest = from;       // no free cell below
+			size_t top = from + span;   // no row reaches past
+			for (auto s : order) {
+				auto& sr = sparse[s];
+				if (sr.empty()) continue;
+				
+				size_t at = lowest > from + sr.front().first ? lowest - sr.front().first : from;
+				for (;; ++at) {
+					bool fits = true;
+					for (auto& e : sr) {
+						if (at + e.first < run.size() && run [at + e.first].state != nostate) { fits = false; break; }
+					}
+					if (fits) break;
+				}
+				
+				if (run.size() < at + sr.back().first + 1) run .resize (at + sr.back().first + 1, combcell { nostate, action () });
+				for (auto& e : sr) { run [at + e.first] = combcell { s, e.second }; }
+				bases[s] = (uint32_t) at;
+				top = std::max (top, at + span);
+				while (lowest != run.size() && run [lowest].state != nostate) ++lowest;
+			}
+			// every read lands inside
+			run .resize (top, combcell { nostate, action () });
+		}
+		
+		// FNV-1a over everything the driver reads. a checkpoint only restores into a parser on the same table
+		uint64_t fingerprint () const {
+			uint64_t h = 0xcbf29ce484222325ull;
+			auto mix = [&](uint64_t v) {
+				for (int i = 0; i != 8; ++i) { h ^= (v >> (i * 8)) & 0xff; h *= 0x100000001b3ull; }
+			};
+			auto mixact = [&](action a) { mix ((uint64_t (a.target) << 4) | a.op); };
+			
+			mix (columns);
+			mix (states());
+			for (size_t i = 0; i != states(); ++i) { for (size_t c = 0; c != columns; ++c) mixact (act (i, c)); }
+			mix (conflicts.size());
+			for (size_t i = 0; i != conflicts.size(); ++i) { mix (conflicts[i].size()); for (auto a : conflicts[i]) mixact (a); }
+			mix (pdata.size());
+			for (auto& p : pdata) { mix (p.first); mix (p.second); }
+			return h;
 		}
 	};
 	
@@ -736,264 +1150,3257 @@ namespace aa {
 		}
 		
 		out << "\n";
-		out << fsm.actions;
+		for (size_t i = 0; i != fsm.states(); ++i) { out << fsm.row (i); }
+		out << fsm.states() << " states in " << fsm.cells.size() << " cells, " << fsm.classes << " classes of bytes\n";
 		return out;
 	}
 	
-	using lrstate = std::vector <size_t>;
-	using lrworkqueue = std::deque <lrstate*>;
-
 /*/// ================================================================================================================================
-	A Test Driver
-	This driver is push driven. Keep giving it tokens until it says no mas. If accepting is set, then we succeeded.
+	Shared Packed Parse Forest
 	
-	If you run out of characters and it's still expecting, then send 0xff. It will eventually signal no mas.
+	Built by the driver as it reduces. A symbol node stands for a var or byte over a span of the input and is shared by
+	every thread that derives the same var over the same span. Each way of deriving it is kept as a packed node: the
+	production and the children it was reduced from. Every parse of the input fits in space polynomial in its length.
 	
+	count() totals the derivations without expanding them. sppfwalk enumerates them one at a time.
 /*/// --------------------------------------------------------------------------------------------------------------------------------
-	using errinfo_fn = std::function <void(const std::string&)>;
+	struct sppfnode;
+	using sppfnodes = std::vector <sppfnode*>;
 	
-	void donothing (const std::string&) { }
+	struct sppfpack {
+		uint32_t  prod;
+		sppfnodes kids;
+	};
 	
-	struct lrparser {
-		actionfsm&  afsm;
-		lrworkqueue states;
-		uint8_t     la;
-		lrstate*    accepting = nullptr;
+	using sppfpacks = std::vector <sppfpack>;
+	
+	struct sppfnode {
+		uint32_t  label;             // the byte for terminals, the column of the var for symbols
+		size_t    start;             // span of the input covered
+		size_t    end;
+		sppfpacks packs;             // empty for terminals
+		uint64_t  count = 0;         // memoized number of derivations
+		uint8_t   counted = 0;       // 0 = not yet, 1 = in progress, 2 = done
+		bool      busy = false;      // on the current path of a walk
 		
-		errinfo_fn  report_error;
+		inline bool terminal () const { return label < 256; }
+	};
+	
+	using sppfkey = std::tuple <uint32_t, size_t, size_t>;
+	
+	const uint64_t sppfmany = std::numeric_limits<uint64_t>::max(); // counts saturate here
+	
+	struct sppf {
+		std::deque <sppfnode>        nodes; // stable addresses
+		std::map <sppfkey, sppfnode*> lookup;
 		
-		lrparser (actionfsm& af) : afsm (af), report_error (donothing) {
-			auto st = new lrstate ();
-			st ->push_back (1);
-			states .push_back (st);
+		sppfnode* find (uint32_t label, size_t start, size_t end) {
+			auto key = sppfkey { label, start, end };
+			auto f = lookup.find (key);
+			if (f != lookup.end()) return f->second;
+			
+			nodes .push_back (sppfnode { label, start, end, sppfpacks () });
+			lookup [key] = &nodes.back();
+			return &nodes.back();
 		}
 		
-		~lrparser () { }
-	
-		inline bool accepted ()  { return accepting != nullptr; }
-		inline bool pending ()   { return !states.empty(); }
-		inline size_t threads () { return states.size(); }
-		
-		inline void on_error_do (errinfo_fn efn) { report_error = efn; }
+		sppfnode* terminal (uint8_t ch, size_t at) { return find (ch, at, at + 1); }
 		
+		// the var derived over start..end by prod from kids. identical derivations are stored once
+		sppfnode* symbol (uint32_t var, uint32_t prod, size_t start, size_t end, sppfnodes& kids) {
+			auto n = find (var, start, end);
+			for (auto& p : n->packs) {
+				if (p.prod == prod && p.kids == kids) return n;
+			}
+			n->packs .push_back (sppfpack { prod, kids });
+			return n;
+		}
 		
-		bool step (uint8_t ch) {
-			la = ch;
-			if (accepting != nullptr) return false;
-			if (states.empty()) return false;
-
-			states .push_back (nullptr); // sentry
-			action act;
-			
-			while (states.front() != nullptr) {
-				auto ls = states.front();
-				states .pop_front();
-
-				another_pass:
-				act = afsm.actions [ls ->back()][la];
-				switch (act.op) {
-				case 0:  for (auto i : *ls) {
-								stringstream out;
-								out << "expecting a ";
-								print_word (out, afsm.errinfo [i]);
-								report_error (out.str());
-							}
-							delete ls;
-							break;
+		// iterative, a right recursive parse is as deep as the input is long. a var that derives itself through unit
+		// productions has infinitely many derivations, those cycles are not counted.
+		uint64_t count (sppfnode* root) {
+			struct frame { sppfnode* n; size_t pack; size_t kid; uint64_t sum; uint64_t prod; };
+			std::vector <frame> todo;
+			
+			auto open = [&](sppfnode* n) {
+				if (n->counted != 0) return;
+				if (n->terminal()) { n->count = 1; n->counted = 2; return; }
+				n->counted = 1;
+				todo .push_back (frame { n, 0, 0, 0, 1 });
+			};
+			auto times = [](uint64_t a, uint64_t b) -> uint64_t {
+				if (a == 0 || b == 0) return 0;
+				return (a > sppfmany / b) ? sppfmany : a * b;
+			};
+			
+			open (root);
+			while (!todo.empty()) {
+				auto& f = todo.back();
+				if (f.pack == f.n->packs.size()) {
+					f.n->count = f.sum; f.n->counted = 2;
+					todo .pop_back ();
+					continue;
+				}
 				
-				case 1: 	ls ->push_back (act.target);
-							states .push_back (ls);
-							break;
+				auto& kids = f.n->packs[f.pack].kids;
+				if (f.kid == kids.size()) {
+					f.sum = (f.sum > sppfmany - f.prod) ? sppfmany : f.sum + f.prod;
+					++f.pack; f.kid = 0; f.prod = 1;
+					continue;
+				}
 				
-				case 2: 	for (int i = 0; i != afsm.pdata [act.target].first; ++i) { // remove |RHS| states
-								ls->pop_back();
-						  	}
-						  	{
-						  		auto next = afsm.actions [ls ->back()][afsm.pdata[act.target].second]; // column of var
-								ls ->push_back (next.target);
-							}
-							goto another_pass;
-
-				case 3: 	ls ->pop_back();
-						  	ls->push_back (act.target);
-							states .push_back (ls);
-							break;
+				auto k = kids[f.kid];
+				if (k->counted == 0) { open (k); continue; } // f may be stale after this
 				
-				case 4: 	{ // conflict... spawn multiple parsers
-								auto& conflicts = afsm.conflicts [act.target];
-								for (auto a : conflicts) {
-									auto nlr = new lrstate (ls->begin(), ls->end());
-									spawn_step (nlr, a);
-								}
-								delete ls;
-							}
- 						   break;
+				f.prod = times (f.prod, (k->counted == 2) ? k->count : 0);
+				++f.kid;
+			}
+			return root->count;
+		}
+	};
+	
+	// walks the derivations of a symbol node in order. a derivation is the packed node chosen for every symbol node in
+	// the tree, listed in preorder. next() moves to the following one by advancing the last choice that can advance.
+	struct sppfwalk {
+		struct choice { sppfnode* node; size_t pack; };
+		using choices = std::vector <choice>;
+		
+		sppfnode* root;
+		choices   tree;
+		bool      valid;
+		
+		explicit sppfwalk (sppfnode* r) : root (r) {
+			valid = (root != nullptr) && expand ();
+			if (!valid && root != nullptr) { valid = next (); }
+		}
+		
+		bool next () {
+			while (!tree.empty()) {
+				auto k = tree.size();
+				while (k != 0 && tree[k-1].pack + 1 == tree[k-1].node->packs.size()) { --k; }
+				if (k == 0) break;
 				
-				case 5: 	if (accepting == nullptr) { accepting = ls; }
-				        	break;
-				}
+				++tree[k-1].pack;
+				tree .resize (k);
+				if (expand ()) { valid = true; return true; }
 			}
-			states .pop_front();
-			return true;
+			tree .clear ();
+			valid = false;
+			return false;
 		}
 		
-		// identical behavior to above. Our only nod to efficiency is to take conflict resolution out of the
-		// happy path. (It's logic is identical to above, so now there's two places to make changes. Enjoy!)
-		void spawn_step (lrstate* ls, action act) {
-			bool nextime = false;
-			another_pass:
-			if (nextime) act = afsm.actions [ls ->back()][la];
-			else nextime = true;
+		// prints the current derivation as (var child ...) with the terminals quoted
+		void print (std::ostream& out, prods& ps) {
+			if (!valid) return;
+			size_t at = 0;
+			print (out, ps, root, at);
+		}
+
+	private:
+		// rebuild the preorder from the choices already made, taking the first packed node everywhere else.
+		// false when the choices lead into a cycle
+		bool expand () {
+			struct frame { sppfnode* n; size_t pack; size_t kid; };
+			std::vector <frame> todo;
+			size_t at = 0;
+			bool ok = true;
 			
-			switch (act.op) {
-			case 0:	for (auto i : *ls) {
-							stringstream out;
-							out << "expecting a ";
-							print_word (out, afsm.errinfo [i]);
-							report_error (out.str());
-						}
-						delete ls;
-						break;
+			auto open = [&](sppfnode* n) -> bool {
+				if (n->terminal()) return true;
+				if (n->busy) return false;
+				if (at == tree.size()) { tree .push_back (choice { n, 0 }); }
+				n->busy = true;
+				todo .push_back (frame { n, tree[at].pack, 0 });
+				++at;
+				return true;
+			};
 			
-			case 1: 	ls ->push_back (act.target);
-						states .push_back (ls);
-						break;
+			ok = open (root);
+			while (ok && !todo.empty()) {
+				auto& f = todo.back();
+				auto& kids = f.n->packs[f.pack].kids;
+				if (f.kid == kids.size()) { f.n->busy = false; todo .pop_back(); continue; }
+				ok = open (kids[f.kid++]);
+			}
+			for (auto& f : todo) { f.n->busy = false; }
+			return ok;
+		}
+		
+		void print (std::ostream& out, prods& ps, sppfnode* n, size_t& at) {
+			struct frame { sppfpack* p; size_t kid; };
+			std::vector <frame> todo;
 			
-			case 2: 	for (int i = 0; i != afsm.pdata [act.target].first; ++i) { // remove |RHS| states
-							ls->pop_back();
-						}
-						{
-							auto next = afsm.actions [ls ->back()][afsm.pdata[act.target].second]; // column of var
-							ls ->push_back (next.target);
-						}
-						goto another_pass;
-
-			case 3: 	ls ->pop_back();
-						ls->push_back (act.target);
-						states .push_back (ls);
-						break;
+			auto open = [&](sppfnode* n) {
+				if (n->terminal()) { out << "'" << (char) n->label << "'"; return; }
+				auto& p = n->packs [tree[at++].pack];
+				out << "(" << std::string (ps[p.prod].lhs.begin()+1, ps[p.prod].lhs.end());
+				todo .push_back (frame { &p, 0 });
+			};
 			
-			case 4: 	{ // conflict... spawn multiple parsers
-							auto& conflicts = afsm.conflicts [act.target];
-							for (auto a : conflicts) {
-								auto nlr = new lrstate (ls->begin(), ls->end());
-								spawn_step (nlr, a);
-							}
-							delete ls;
-						}
-						break;
-					
-			case 5: 	if (accepting == nullptr) { accepting = ls; }
-						break;
+			open (n);
+			while (!todo.empty()) {
+				auto& f = todo.back();
+				if (f.kid == f.p->kids.size()) { out << ")"; todo .pop_back(); continue; }
+				out << " ";
+				open (f.p->kids[f.kid++]);
 			}
 		}
-		
-		
 	};
 	
-	
 /*/// ================================================================================================================================
+	Graph Structured Stack
+	
+	Tomita style. Each node is a state reached at an input position. Threads that fork on a conflict share the common
+	prefix of their stacks through the links, and threads that reach the same state at the same position are merged
+	into one node. The work done per byte depends on the number of distinct states alive, not on the depth of the stacks.
+	
+	Nodes are reference counted. A node is held by the nodes that link to it, by the frontier and by the accept slot.
+	
+	Nodes are not given back to the heap. Each parser carves them from slabs and recycles the dead ones, links included,
+	so once the stacks have grown to their working size a parse makes no allocations.
 /*/// --------------------------------------------------------------------------------------------------------------------------------
-	namespace lr {
+	struct gssnode;
 
-		void generate_from (rulesview& rv) {
-			prods ps;
-			uint32_t id = 256;
-			for (auto& i : rv) {
-				ps .emplace_back (prod (i));
-				ps.back().id = id;
-				++id;
+	struct gsslink {
+		gssnode*  node;
+		sppfnode* tree;              // what was shifted or reduced between node and the one above, when building a forest
+		uint32_t  value = 0;         // the same, as the slot of a user action's value, when acting
+	};
+	
+	const uint32_t linkscan = 8;      // links searched one by one, past this they are hashed
+	
+	// nearly every node has one or two links, those are kept inline. more spill to the heap, and the spilled buffer
+	// stays with the node when it is recycled. a node collapsing a right recursive chain gets a link for every level
+	// below it, so past linkscan links the search for a duplicate goes through a table of link numbers, open addressed
+	struct gsslinks {
+		gsslink  inl [2];
+		gsslink* at = inl;
+		uint32_t count = 0;
+		uint32_t room = 2;
+		uint32_t* slots = nullptr;   // link number + 1 by hash of node and tree, 0 where empty
+		uint32_t mask = 0;           // slots - 1, a power of two less one
+		uint32_t hashed = 0;         // links entered in the slots, they are caught up on the next search
+		
+		gsslinks () { }
+		~gsslinks () { if (at != inl) delete [] at; delete [] slots; }
+		gsslinks (const gsslinks&) = delete;
+		gsslinks& operator= (const gsslinks&) = delete;
+		
+		inline gsslink* begin () { return at; }
+		inline gsslink* end ()   { return at + count; }
+		inline size_t size () const { return count; }
+		inline bool empty () const { return count == 0; }
+		inline gsslink& front () { return at [0]; }
+		inline gsslink& back ()  { return at [count - 1]; }
+		inline void clear () { count = 0; hashed = 0; }
+		
+		void push_back (const gsslink& l) {
+			if (count == room) {
+				auto more = new gsslink [room * 2];
+				std::copy (at, at + count, more);
+				if (at != inl) delete [] at;
+				at = more;
+				room *= 2;
 			}
-			
-			cout << ps;
-			cout << "\n\n\n";
-			
-			auto first = calculate_first_sets (ps);
-			cout << "Firsts\n";
-			cout << first;
-			cout << "\n\n\n";
-			
-			auto follow = calculate_follow_sets (ps, first);
-			cout << "Follows\n";
-			cout << follow;
-			cout << "\n\n\n";
-
-			auto items  = create_closures (ps, first);
-			cout << items;
+			at [count++] = l;
 		}
-
-		bool parse_using (rulesview& rv, namesview& nv,  const char* filename) {
-			prods ps;
-			idmap ids;
-			
-			{  uint32_t id = 0;
-				for (auto& i : rv) {
-					ps .emplace_back (prod (i));
-					ps.back().id = id;
-					++id;
-				}
+		
+		bool has (gssnode* n, sppfnode* t) {
+			if (count <= linkscan) {
+				for (auto& l : *this) { if (l.node == n && l.tree == t) return true; }
+				return false;
 			}
-			
-			{
-				ids["V~S~"] = 256;
-				uint32_t id = 257;
-				for (auto& i : nv) { std::string s = "V"; s.append (i); ids[s] = id; ++id; }
+			if (hashed == 0 || mask + 1 < count * 2) {
+				uint32_t size = 16;
+				while (size < count * 4) size *= 2;
+				if (size != mask + 1) { delete [] slots; slots = new uint32_t [size]; mask = size - 1; }
+				std::fill (slots, slots + size, 0u);
+				hashed = 0;
 			}
-			
-			cout << ps;
-			cout << "\n\n\n";
-			
-			auto first = calculate_first_sets (ps);
-			cout << "Firsts\n";
-			cout << first;
-			cout << "\n\n\n";
-			
-			auto follow = calculate_follow_sets (ps, first);
-			cout << "Follows\n";
-			cout << follow;
-			cout << "\n\n\n";
+			for (; hashed != count; ++hashed) {
+				auto i = slot (at [hashed].node, at [hashed].tree);
+				while (slots [i] != 0) i = (i + 1) & mask;
+				slots [i] = hashed + 1;
+			}
+			for (auto i = slot (n, t); slots [i] != 0; i = (i + 1) & mask) {
+				auto& l = at [slots [i] - 1];
+				if (l.node == n && l.tree == t) return true;
+			}
+			return false;
+		}
+		
+		inline uint32_t slot (gssnode* n, sppfnode* t) const {
+			auto h = ((uintptr_t) n ^ ((uintptr_t) t << 1)) * 0x9e3779b97f4a7c15ull;
+			return (uint32_t) (h >> 32) & mask;
+		}
+	};
 
-			auto items  = create_closures (ps, first);
-			cout << items;
-			
-			auto afsm = std::unique_ptr<actionfsm> (new actionfsm (items, ps, ids));
-			auto parser = lrparser (*afsm);
-			strings errs;
-			size_t line = 1;
-			
-			parser.on_error_do ([&](const std::string& s)->void {
-				if (parser.threads() <= 2) {
-					string report ("Error at line ");
-					report .append (std::to_string (line));
-					report .append (": ");
-					report .append (s);
-					errs .push_back (report);
-				}
-			});
-			
-			cout << "\n\n\n";
-			cout << *afsm;
+	struct gssnode {
+		size_t   level = 0;          // input position at which the state was reached
+		std::atomic <size_t> refs { 0 };
+		size_t   rank = 0;           // alternatives taken that were not first in their conflict list, fewest over all stacks
+		size_t   depth = 1;          // shortest stack through this node
+		uint32_t state = 0;          // an action's target is 28 bits, a state never needs more
+		bool     reduced = false;    // all reductions on the current lookahead have been applied
+		bool     base = false;       // bottom of a speculative guess, the stacks underneath are not known
+		gsslinks links;              // the stacks underneath this node
+		
+		bool links_to (gssnode* n, sppfnode* t) { return links .has (n, t); }
+	};
+	
+	using gssnodes = std::vector <gssnode*>;
+	using gssindex = std::vector <gssnode*>;      // state to node, for the frontier. null where the state is not alive
+
+	const size_t gssslab = 256;   // nodes per slab
+	
+	struct gsspool {
+		std::vector <std::unique_ptr <gssnode[]>> slabs;
+		gssnodes spare;              // dead nodes, ready to be handed out again
+		gssnodes dead;               // scratch for release
+		bool     shared = false;     // stacks are shared with parsers on other threads, count references atomically
+		lr::hooks* hooks = nullptr;  // told when a link holding a value dies
+		
+		inline gssnode* retain (gssnode* n) {
+			if (shared) { n->refs .fetch_add (1, std::memory_order_relaxed); }
+			else        { n->refs .store (n->refs.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+			return n;
+		}
+		
+		// true when that was the last reference
+		inline bool drop (gssnode* n) {
+			if (shared) return n->refs .fetch_sub (1, std::memory_order_acq_rel) == 1;
+			auto r = n->refs.load (std::memory_order_relaxed) - 1;
+			n->refs .store (r, std::memory_order_relaxed);
+			return r == 0;
+		}
+		
+		gssnode* make (uint32_t state, size_t level) {
+			if (spare.empty()) {
+				slabs .emplace_back (new gssnode [gssslab]);
+				for (size_t i = gssslab; i != 0; --i) { spare .push_back (&slabs.back()[i-1]); }
+			}
+			auto n = spare.back(); spare .pop_back();
+			n->state = state; n->level = level;
+			n->refs .store (0, std::memory_order_relaxed);
+			n->rank = 0; n->depth = 1;
+			n->reduced = false; n->base = false;
+			n->links .clear ();
+			return n;
+		}
+		
+		// iterative, stacks get as deep as the input is long on right recursive grammars
+		void release (gssnode* n) {
+			if (!drop (n)) return;
+			dead .push_back (n);
 			
-			cout << "\n\n\n";
-			std::ifstream in (filename);
-			if (!in.fail()) {
-				uint8_t ch = in.eof() ? '\xff' : in.get();
-				if (ch == '\n') ++line;
-				
-				while (parser.step (ch)) {
-					ch = in.eof() ? '\xff' : in.get();
-				}
-				
-				if (!parser.accepted()) {
-					for (auto& i : errs) { cout << i << "\n"; }
-					return false;
+			while (!dead.empty()) {
+				auto d = dead.back(); dead .pop_back();
+				for (auto& l : d->links) {
+					if (l.value != 0) hooks->drop (l.value);
+					if (drop (l.node)) dead .push_back (l.node);
 				}
-				else return true;
-			}
-			else {
-				cout << "Unable to open file " << filename << "\n";
+				spare .push_back (d);
 			}
-			return false;
+		}
+		
+		// take over another pool's nodes, for when nodes made by one parser end up in another's stacks
+		void merge (gsspool& other) {
+			for (auto& s : other.slabs) { slabs .push_back (std::move (s)); }
+			spare .insert (spare.end(), other.spare.begin(), other.spare.end());
+			other.slabs .clear ();
+			other.spare .clear ();
+		}
+	};
+
+/*/// ================================================================================================================================
+	A Test Driver
+	This driver is push driven. Keep giving it tokens until it says no mas. If accepting is set, then we succeeded.
+	
+	If you run out of characters and it's still expecting, then send 0xff. It will eventually signal no mas.
+	
+	A lexer can send it tokens instead of bytes with step_on. A token is looked up in its own column and moves the
+	input position past every byte it covers, so positions stay byte offsets either way.
+	
+	A beam bounds the number of threads. After every shift the frontier is cut down to the beam, keeping the threads the
+	pruning policy prefers. Ties keep frontier order, so the cut is deterministic. A beam of 0 leaves the parser unbounded.
+	
+	With a forest, every link carries the forest node for what it shifted or reduced, and the root of the forest is
+	the start symbol over the whole input once the parse is accepted.
+	
+	With hooks, every link carries a value the same way: the hooks make one for each byte shifted and for each
+	reduction from the values along the path it pops. A value is counted once for each link holding it, and the hooks
+	are told when the last one dies. Checkpoints, guesses and handing threads over don't carry values.
+	
+	Each step runs in two phases over the frontier. The first applies every reduction (and the reductions they expose)
+	until the frontier stops growing. The second shifts the lookahead, which builds the next frontier, and records the
+	threads that die.
+	
+	A dead thread costs an lrerror: where it died and its state. Nothing is formatted while parsing. Only a step that
+	kills every thread is an error, the records of a step that others survive are dropped again, so errors holds one
+	step's worth, or one for each time the parse recovered. describe() turns the records of one position into text from
+	the bytes their states expected, for callers that want to see it.
+	
+	With recovery on, a parse whose threads have all died picks itself up, panic mode. Every var some state a few layers
+	down the dead stacks has a goto on is a place to resume: the input is skipped until a byte that the state the goto
+	leads to has an action for, and every goto that can take that byte is resumed at once. The table's lookaheads are
+	tighter than FOLLOW sets, so they are used instead.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	struct lrerror {
+		size_t   at;      // input position of the byte it died on
+		uint32_t state;   // top of its stack
+	};
+	
+	using lrerrors = std::vector <lrerror>;
+	
+	void describe_byte (std::ostream& out, size_t c) {
+		if (c == 0xff) { out << "EOS"; }
+		else
+		if (c > ' ' && c < 0x7f) { out << "'" << (char) c << "'"; }
+		else { out << "\\x" << std::hex << std::setw (2) << std::setfill ('0') << c << std::dec << std::setfill (' '); }
+	}
+	
+	// a set of bytes that was wanted, runs of three or more as ranges, after the tokens that were
+	void describe (std::ostream& out, const std::bitset <256>& want, const strings& tokens = strings ()) {
+		out << (want.count() + tokens.size() == 1 ? "expecting " : "expecting one of ");
+		bool sep = false;
+		for (auto& t : tokens) {
+			if (sep) out << ", "; else sep = true;
+			out << t;
+		}
+		for (size_t c = 0; c != 256; ) {
+			if (!want [c]) { ++c; continue; }
+			size_t last = c;
+			while (last + 1 < 0xff && want [last + 1]) ++last;
+			if (sep) out << ", "; else sep = true;
+			if (last - c >= 2) {
+				out << "["; describe_byte (out, c); out << "-"; describe_byte (out, last); out << "]";
+			}
+			else {
+				for (auto b = c; b <= last; ++b) { if (b != c) out << ", "; describe_byte (out, b); }
+			}
+			c = last + 1;
+		}
+		if (!sep) out << "nothing";
+	}
+	
+	// the records from from to to died at the same position. what any of them wanted
+	void describe (std::ostream& out, const actionfsm& afsm, lrerrors::const_iterator from, lrerrors::const_iterator to) {
+		std::bitset <256> want;
+		for (auto e = from; e != to; ++e) { want |= afsm.expects [e->state]; }
+		describe (out, want);
+	}
+	
+	// where the next run of records at one position ends
+	lrerrors::const_iterator same_position (lrerrors::const_iterator from, lrerrors::const_iterator end) {
+		auto to = from;
+		while (to != end && to->at == from->at) ++to;
+		return to;
+	}
+	
+	// checkpoints are written in LEB128, small numbers take a byte
+	void put_varint (std::ostream& out, uint64_t v) {
+		do {
+			uint8_t b = v & 0x7f;
+			v >>= 7;
+			if (v != 0) b |= 0x80;
+			out .put ((char) b);
+		} while (v != 0);
+	}
+	
+	bool get_varint (std::istream& in, uint64_t& v) {
+		v = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			int c = in .get ();
+			if (c == std::istream::traits_type::eof()) return false;
+			v |= uint64_t (c & 0x7f) << shift;
+			if ((c & 0x80) == 0) return true;
+		}
+		return false;
+	}
+	
+	const char     checkpoint_magic[4] = { 'a', 'a', 'l', 'r' };
+	const uint64_t checkpoint_version  = 1;
+	
+	const size_t recoverdepth = 8;    // layers of the dead stacks searched for a place to resume
+	
+	struct lrparser {
+		actionfsm&  afsm;
+		gsspool     pool;           // where this parser's nodes come from
+		gssnodes    frontier;       // top of every live stack
+		gssindex    index;          // state -> node for the frontier
+		gssnodes    work;           // frontier nodes whose reductions are pending
+		std::vector <std::pair <gssnode*, gsslink>> relinks;   // links made to nodes already reduced, and whose paths are pending
+		gssnodes    current;        // the frontier being shifted from
+		lrerrors    errors;         // threads that died in the steps that killed every thread, oldest first
+		size_t      level = 0;      // input position
+		uint32_t    la;             // the column of the lookahead, its byte or, when lexing, its token
+		uint32_t    lk = 0;         // where la is in a row of the action table
+		size_t      width = 1;      // bytes the lookahead covers
+		gssnode*    accepting = nullptr;
+		size_t      beam = 0;       // most threads kept alive, 0 for no limit
+		lr::prune   policy = lr::prune::priority;
+		size_t      pruned = 0;     // threads dropped to stay within the beam
+		sppf*       forest = nullptr;
+		gssnodes    guess;          // nodes copied in by seed, the copies of the frontier first
+		size_t      tops = 0;       // how many of them were the frontier
+		size_t      origin = 0;     // input position the guess stands for
+		bool        recover = false;   // pick the parse up again when every thread has died
+		size_t      recovered = 0;     // times it had to
+		size_t      skipped = 0;       // bytes skipped to get going again
+		std::vector <std::pair <gssnode*, uint32_t>> resync;   // while recovering, a node and the state a goto from it reaches
+		bool        underflow = false; // a reduction popped through a base, the guess is useless
+		const std::atomic <bool>* cancel = nullptr; // stops the parse when set, by whoever races this parser
+		lr::hooks*  hooks = nullptr;   // user actions, run at every shift and reduction
+		
+		lrparser (actionfsm& af) : afsm (af), index (af.states()) {
+			add_node (1, nullptr, 0, nullptr, 0);
+		}
+		
+		~lrparser () { clear (); }
+		
+		lrparser (const lrparser&) = delete;
+		lrparser& operator= (const lrparser&) = delete;
+	
+		inline bool accepted ()  { return accepting != nullptr; }
+		inline bool pending ()   { return !frontier.empty() || !resync.empty(); }
+		inline size_t threads () { return frontier.size(); }
+		
+		inline void bound (size_t b, lr::prune p) { beam = b; policy = p; }
+		inline void build (sppf* f) { forest = f; }
+		inline void cancel_on (const std::atomic <bool>* c) { cancel = c; }
+		inline void recover_on (bool r) { recover = r; }
+		inline bool cancelled () { return cancel != nullptr && cancel->load (std::memory_order_relaxed); }
+		inline void act_with (lr::hooks* h) { hooks = h; pool.hooks = h; }
+		
+		// every derivation of the input, once accepted with a forest
+		sppfnode* root () {
+			if (accepting == nullptr || accepting->links.empty()) return nullptr;
+			return accepting->links.front().tree;
+		}
+		
+		// the value of the start symbol, once accepted with hooks
+		uint32_t result () {
+			if (accepting == nullptr || accepting->links.empty()) return 0;
+			return accepting->links.front().value;
+		}
+		
+		bool step (uint8_t ch) {
+			if (accepting != nullptr) return false;
+			if (!pending() || cancelled()) return false;
+			advance (ch);
+			return true;
+		}
+		
+		// the same for a token a lexer matched over w bytes, by its column
+		bool step_on (uint32_t col, size_t w) {
+			if (accepting != nullptr) return false;
+			if (!pending() || cancelled()) return false;
+			width = w;
+			advance (col);
+			width = 1;
+			return true;
+		}
+		
+		// some live thread has an action on col
+		bool takes (uint32_t col) {
+			for (auto n : frontier) { if (afsm.act (n->state, col).op != 0) return true; }
+			return false;
+		}
+		
+		// run a whole span through the parser. stops at the end of the span, on accepting or when every thread has died.
+		// returns where it stopped
+		const uint8_t* feed (const uint8_t* begin, const uint8_t* end) {
+			while (begin != end && accepting == nullptr && pending() && !underflow && !cancelled()) {
+				advance (*begin++);
+			}
+			return begin;
+		}
+		
+		// the input is over. send 0xff until the parser says no mas
+		bool finish () {
+			while (step (0xff)) { }
+			return accepted ();
+		}
+		
+		// write the whole state of the parse: every live stack, the lookahead and the accept slot. nodes go out below
+		// first and links name nodes already written. a parse building a forest or running on a guess can't be saved
+		bool save (std::ostream& out) {
+			if (forest != nullptr || hooks != nullptr || !guess.empty() || !resync.empty()) return false;
+			
+			std::map <gssnode*, size_t> number;
+			gssnodes order;
+			gssnodes roots = frontier;
+			if (accepting != nullptr) { roots .push_back (accepting); }
+			
+			// post order, iterative. stacks are as deep as the input is long on right recursive grammars
+			std::vector <std::pair <gssnode*, size_t>> todo;
+			for (auto r : roots) {
+				if (number.count (r) != 0) continue;
+				number [r] = 0;
+				todo .push_back ({ r, 0 });
+				while (!todo.empty()) {
+					auto& t = todo.back();
+					if (t.second == t.first->links.size()) {
+						number [t.first] = order.size();
+						order .push_back (t.first);
+						todo .pop_back ();
+						continue;
+					}
+					auto below = t.first->links.begin() [t.second++].node;
+					if (number.count (below) == 0) { number [below] = 0; todo .push_back ({ below, 0 }); }
+				}
+			}
+			
+			out .write (checkpoint_magic, sizeof (checkpoint_magic));
+			put_varint (out, checkpoint_version);
+			put_varint (out, afsm.fingerprint ());
+			put_varint (out, level);
+			put_varint (out, la);
+			put_varint (out, pruned);
+			
+			put_varint (out, order.size());
+			for (auto n : order) {
+				put_varint (out, n->state);
+				put_varint (out, level - n->level);
+				put_varint (out, n->rank);
+				put_varint (out, n->depth);
+				put_varint (out, n->links.size());
+				for (auto& l : n->links) { put_varint (out, number [l.node]); }
+			}
+			
+			put_varint (out, frontier.size());
+			for (auto n : frontier) { put_varint (out, number [n]); }
+			put_varint (out, accepting == nullptr ? 0 : number [accepting] + 1);
+			return out.good ();
+		}
+		
+		// replace the state of this parser with a saved one. false, and the parser as it was, when the blob is damaged
+		// or was saved against another action table
+		bool restore (std::istream& in) {
+			char magic [sizeof (checkpoint_magic)];
+			if (!in .read (magic, sizeof (magic)) || memcmp (magic, checkpoint_magic, sizeof (magic)) != 0) return false;
+			
+			uint64_t version, print, lv, ch, dropped, count;
+			if (!get_varint (in, version) || version != checkpoint_version) return false;
+			if (!get_varint (in, print) || print != afsm.fingerprint ()) return false;
+			if (!get_varint (in, lv) || !get_varint (in, ch) || ch > 0xff || !get_varint (in, dropped)) return false;
+			if (!get_varint (in, count)) return false;
+			
+			// every node is held here until it is linked in, so a bad blob lets go of all of them
+			gssnodes made;
+			auto fail = [&]() { for (auto n : made) release (n); return false; };
+			
+			for (uint64_t i = 0; i != count; ++i) {
+				uint64_t state, back, rank, depth, links;
+				if (!get_varint (in, state) || state >= afsm.states()) return fail ();
+				if (!get_varint (in, back) || back > lv) return fail ();
+				if (!get_varint (in, rank) || !get_varint (in, depth) || !get_varint (in, links)) return fail ();
+				
+				auto n = retain (pool.make (state, lv - back));
+				made .push_back (n);
+				n->rank = rank;
+				n->depth = depth;
+				for (uint64_t k = 0; k != links; ++k) {
+					uint64_t at;
+					if (!get_varint (in, at) || at >= i) return fail ();
+					n->links .push_back (gsslink { retain (made [at]), nullptr });
+				}
+			}
+			
+			uint64_t tops, acc;
+			if (!get_varint (in, tops)) return fail ();
+			gssnodes top;
+			std::set <size_t> states;
+			for (uint64_t i = 0; i != tops; ++i) {
+				uint64_t at;
+				if (!get_varint (in, at) || at >= count || !states.insert (made [at]->state).second) return fail ();
+				top .push_back (made [at]);
+			}
+			if (!get_varint (in, acc) || acc > count) return fail ();
+			
+			for (auto n : frontier) { index [n->state] = nullptr; release (n); }
+			frontier .clear ();
+			if (accepting != nullptr) { release (accepting); accepting = nullptr; }
+			
+			for (auto n : top) {
+				frontier .push_back (retain (n));
+				index [n->state] = n;
+			}
+			if (acc != 0) { accepting = retain (made [acc - 1]); }
+			level = lv; la = (uint32_t) ch; lk = afsm.colof [la]; pruned = dropped;
+			
+			for (auto n : made) release (n);
+			return true;
+		}
+		
+		// drop every stack. the parser is left with nothing to do until it is started again
+		void clear () {
+			for (auto n : frontier) { index [n->state] = nullptr; release (n); }
+			for (auto n : guess) { release (n); }
+			for (auto& r : resync) { release (r.first); }
+			if (accepting != nullptr) { release (accepting); }
+			frontier .clear ();
+			resync .clear ();
+			guess .clear ();
+			accepting = nullptr;
+			tops = 0;
+			underflow = false;
+		}
+		
+		// the top layer of the stacks, copied so the steps to come don't change it. the layers underneath are never
+		// changed once the parser is past them, so the copies share those. each copy is held once for the caller
+		gssnodes snapshot () {
+			gssnodes copies;
+			for (auto n : frontier) { copies .push_back (retain (copy_of (n))); }
+			return copies;
+		}
+		
+		// drop our stacks and carry on at position at from a snapshot, which is left as it was
+		void start_from (const gssnodes& snap, size_t at) {
+			clear ();
+			for (auto n : snap) {
+				auto c = retain (copy_of (n));
+				frontier .push_back (c);
+				index [c->state] = c;
+			}
+			level = at;
+			while (!errors.empty() && errors.back().at >= at) { errors .pop_back (); }
+		}
+		
+		// hand a live thread to another parser, or take one. only between steps, when the frontier was all just shifted
+		// and nothing links to it. the stacks underneath stay shared, so both parsers need shared pools
+		gssnode* give () {
+			auto n = frontier.back(); frontier .pop_back();
+			index [n->state] = nullptr;
+			return n;
+		}
+		
+		void take (gssnode* n) {
+			level = n->level;   // it was just shifted, so it is at the giver's position. ours is stale if we had nothing
+			auto m = index [n->state];
+			if (m == nullptr) {
+				frontier .push_back (n);
+				index [n->state] = n;
+				return;
+			}
+			// the state is already alive here, fold the stacks into one node
+			for (auto& l : n->links) {
+				if (!m->links_to (l.node, l.tree)) { m->links .push_back (gsslink { retain (l.node), l.tree }); }
+			}
+			m->rank = std::min (m->rank, n->rank);
+			m->depth = std::min (m->depth, n->depth);
+			release (n);
+		}
+		
+		// speculate. drop our stacks and start at position at from a copy of the top layers of another parser's stacks.
+		// the deepest layer copied is made of bases
+		void seed (lrparser& from, size_t layers, size_t at) {
+			for (auto n : frontier) { index [n->state] = nullptr; release (n); }
+			frontier .clear ();
+			level = origin = at;
+			
+			std::map <gssnode*, gssnode*> copies;
+			gssnodes layer = from.frontier, below;
+			for (size_t d = 0; d != layers && !layer.empty(); ++d) {
+				for (auto n : layer) {
+					auto c = retain (pool.make (n->state, n->level));
+					c->rank = n->rank; c->depth = n->depth;
+					c->base = (d + 1 == layers);
+					copies [n] = c;
+					guess .push_back (c);
+				}
+				below .clear ();
+				for (auto n : layer) {
+					for (auto& l : n->links) {
+						if (copies.count (l.node) == 0 && std::find (below.begin(), below.end(), l.node) == below.end()) {
+							below .push_back (l.node);
+						}
+					}
+				}
+				layer .swap (below);
+			}
+			
+			for (auto& c : copies) {
+				if (c.second->base) continue;
+				for (auto& l : c.first->links) { c.second->links .push_back (gsslink { retain (copies [l.node]), l.tree }); }
+			}
+			
+			tops = from.frontier.size();
+			for (size_t i = 0; i != tops; ++i) {
+				frontier .push_back (retain (guess[i]));
+				index [guess[i]->state] = guess[i];
+			}
+		}
+		
+		// take over what a seeded parser built on its guess, if the guess was right: it never popped through a base and
+		// the layers it copied match the top of our stacks state for state. false leaves this parser as it was.
+		// where a node links to more than one node in the same state, as merged threads of different lengths do, the
+		// one as many bytes back from the top as in the guess is taken
+		bool adopt (lrparser& spec) {
+			if (spec.underflow || spec.accepting != nullptr || spec.origin != level || spec.tops != frontier.size()) return false;
+			
+			auto gtop = spec.guess.front()->level;
+			std::map <gssnode*, gssnode*> to;   // guess -> ours
+			std::set <gssnode*> used;
+			std::vector <std::pair <gssnode*, gssnode*>> todo;
+			for (size_t i = 0; i != spec.tops; ++i) {
+				auto r = index [spec.guess[i]->state];
+				if (r == nullptr) return false;
+				todo .push_back ({ spec.guess[i], r });
+			}
+			
+			while (!todo.empty()) {
+				auto g = todo.back().first, r = todo.back().second;
+				todo .pop_back ();
+				if (g->state != r->state) return false;
+				
+				auto m = to.find (g);
+				if (m != to.end()) { if (m->second != r) return false; continue; }
+				if (!used.insert (r).second) return false;
+				to [g] = r;
+				
+				if (g->base) continue;
+				if (g->links.size() != r->links.size()) return false;
+				for (auto& l : g->links) {
+					gssnode* only = nullptr, *near = nullptr;
+					size_t   same = 0, nears = 0;
+					for (auto& k : r->links) {
+						if (k.node->state != l.node->state) continue;
+						only = k.node; ++same;
+						if (gtop - l.node->level == level - k.node->level) { near = k.node; ++nears; }
+					}
+					auto match = same == 1 ? only : nears == 1 ? near : nullptr;
+					if (match == nullptr) return false;
+					todo .push_back ({ l.node, match });
+				}
+			}
+			for (auto n : spec.frontier) { if (to.count (n) != 0) return false; }
+			
+			// the guess was right. relink whatever was built on it onto our nodes
+			std::set <gssnode*> seen;
+			gssnodes visit = spec.frontier;
+			while (!visit.empty()) {
+				auto n = visit.back(); visit .pop_back();
+				if (!seen.insert (n).second) continue;
+				for (auto& l : n->links) {
+					auto m = to.find (l.node);
+					if (m == to.end()) { visit .push_back (l.node); continue; }
+					l.node = retain (m->second);
+					release (m->first);
+				}
+			}
+			
+			for (auto n : frontier) { index [n->state] = nullptr; release (n); }
+			frontier .swap (spec.frontier);
+			for (auto n : frontier) { spec.index [n->state] = nullptr; index [n->state] = n; }
+			spec.frontier .clear ();
+			level = spec.level;
+			
+			// the nodes are ours now, and so are the slabs they live in
+			pool .merge (spec.pool);
+			for (auto g : spec.guess) { release (g); }
+			spec.guess .clear ();
+			return true;
+		}
+		
+	private:
+		gssnode* copy_of (gssnode* n) {
+			auto c = pool.make (n->state, n->level);
+			c->rank = n->rank;
+			c->depth = n->depth;
+			for (auto& l : n->links) { c->links .push_back (gsslink { retain (l.node), l.tree }); }
+			return c;
+		}
+		
+		inline gssnode* retain (gssnode* n) { return pool .retain (n); }
+		inline void release (gssnode* n) { pool .release (n); }
+		
+		inline void advance (uint32_t col) {
+			la = col;
+			lk = afsm.colof [col];
+			if (!resync.empty() && !resume (col)) { level += width; return; }
+			
+			// phase one - reductions. a new link to a node already reduced only needs the paths through it, and those
+			// queue up behind the nodes rather than run from go_to. a right recursive chain collapses one link at a time
+			// at the end of the input, and run from go_to each of those would be a call deeper
+			work = frontier;
+			while (!work.empty() || !relinks.empty()) {
+				if (!relinks.empty()) {
+					auto r = relinks.back(); relinks .pop_back();
+					reduce_on (r.first, afsm.at (r.first->state, lk), &r.second);
+					continue;
+				}
+				auto n = work.back(); work .pop_back();
+				n->reduced = true;
+				reduce_on (n, afsm.at (n->state, lk), nullptr);
+			}
+			
+			// phase two - shifts, accepts and failures
+			current .swap (frontier);
+			frontier .clear ();
+			for (auto n : current) { index [n->state] = nullptr; }
+			level += width;
+			
+			size_t died = errors.size();
+			for (auto n : current) {
+				shift_on (n, afsm.at (n->state, lk));
+			}
+			
+			// threads dying while others go on are not errors. only a step that kills them all is
+			if (!frontier.empty() || accepting != nullptr) { errors .resize (died); }
+			if (frontier.empty() && recover && accepting == nullptr && la != 0xff) { fall_back (); }
+			
+			for (auto n : current) { release (n); }
+			current .clear ();
+			if (beam != 0 && frontier.size() > beam) { prune (); }
+		}
+		
+		// every thread died on the byte just shifted. find where the dead stacks could resume, skipping input
+		void fall_back () {
+			std::set <gssnode*> seen;
+			gssnodes layer = current, below;
+			for (size_t d = 0; d != recoverdepth && !layer.empty(); ++d) {
+				below .clear ();
+				for (auto n : layer) {
+					if (!seen.insert (n).second) continue;
+					for (size_t col = 256; col < afsm.columns; ++col) {
+						auto act = afsm.act (n->state, col);
+						if (act.op == 3) { resync .push_back ({ retain (n), (uint32_t) act.target }); }
+						else
+						if (act.op == 4) {
+							for (auto a : afsm.conflicts [act.target]) { if (a.op == 3) resync .push_back ({ retain (n), (uint32_t) a.target }); }
+						}
+					}
+					for (auto& l : n->links) { below .push_back (l.node); }
+				}
+				layer .swap (below);
+			}
+			// the byte that killed them is skipped as well, it was never shifted
+			if (!resync.empty()) { ++recovered; skipped += width; }
+		}
+		
+		// resume every goto whose state can take col. false when there are none, and col is skipped. the end of the
+		// input can't be skipped, the parse is over
+		bool resume (uint32_t col) {
+			bool found = false;
+			for (auto& r : resync) {
+				if (afsm.act (r.second, col).op != 0) {
+					add_node (r.second, r.first, r.first->rank, nullptr, 0);
+					found = true;
+				}
+			}
+			if (!found && col != 0xff) { skipped += width; return false; }
+			
+			for (auto& r : resync) { release (r.first); }
+			resync .clear ();
+			return found;
+		}
+		
+		// find the node for state in the frontier or make one. link it to below. true when a new link was made.
+		bool add_node (uint32_t state, gssnode* below, size_t rank, sppfnode* tree, uint32_t value, gssnode** out = nullptr) {
+			auto n = index [state];
+			
+			if (n == nullptr) {
+				n = retain (pool.make (state, level));
+				n->rank = rank;
+				if (below != nullptr) { n->depth = below->depth + 1; }
+				frontier .push_back (n);
+				index [state] = n;
+				work .push_back (n);
+			}
+			else {
+				n->rank = std::min (n->rank, rank);
+				if (below == nullptr || n->links_to (below, tree)) { return false; }
+				n->depth = std::min (n->depth, below->depth + 1);
+			}
+			
+			if (below != nullptr) {
+				n->links .push_back (gsslink { retain (below), tree, value });
+				if (value != 0) hooks->share (value);
+			}
+			if (out != nullptr) { *out = n; }
+			return true;
+		}
+		
+		void reduce_on (gssnode* n, action act, gsslink* via) {
+			switch (act.op) {
+			case 2:	reduce (n, act.target, via, n->rank);
+						break;
+
+			case 4: 	{ // conflict... every reduction is applied
+							size_t alt = 0;
+							for (auto a : afsm.conflicts [act.target]) {
+								if (a.op == 2) { reduce (n, a.target, via, n->rank + alt); }
+								++alt;
+							}
+						}
+						break;
+			}
+		}
+		
+		struct gsspath {
+			gssnode*  end;
+			size_t    kids;              // where its kids start in endkids, left to right, when building a forest or acting
+		};
+		using gsspaths = std::vector <gsspath>;
+		using gsskids  = std::vector <gsslink>;
+		
+		struct gssstep {
+			gssnode*  node;
+			size_t    depth;            // states left to pop below it
+			uint32_t  next;             // its next link to follow
+		};
+		
+		// scratch for reduce, kept so the steady state does not allocate. reductions run one at a time from advance,
+		// but each one still only uses what lies above the marks it took on the way in
+		gsspaths    ends;
+		gsskids     endkids;
+		gsskids     pathkids;       // the links of the path being walked, top first
+		std::vector <gssstep> steps;   // the path being walked, as a stack
+		sppfnodes   kids;
+		std::vector <uint32_t> kidvalues;
+		
+		inline bool keeping_kids () { return forest != nullptr || hooks != nullptr; }
+		
+		// pop |RHS| states along every path below n (that starts with via, if given) and goto on the var
+		void reduce (gssnode* n, uint32_t prod, gsslink* via, size_t rank) {
+			auto& pd = afsm.pdata [prod];
+			size_t mark = ends.size(), kidmark = endkids.size();
+			
+			if (pd.first == 0) {
+				if (via != nullptr) return;
+				ends .push_back (gsspath { n, kidmark });
+			}
+			else
+			if (via != nullptr) {
+				pathkids .push_back (*via);
+				walk (via->node, pd.first - 1);
+				pathkids .pop_back ();
+			}
+			else {
+				walk (n, pd.first);
+			}
+			
+			for (size_t i = mark, stop = ends.size(); i != stop; ++i) {
+				auto e = ends[i];
+				sppfnode* tree = nullptr;
+				if (forest != nullptr) {
+					kids .clear ();
+					for (size_t k = 0; k != pd.first; ++k) { kids .push_back (endkids [e.kids + k].tree); }
+					tree = forest->symbol (pd.second, prod, e.end->level, level, kids);
+				}
+				uint32_t value = 0;
+				if (hooks != nullptr) {
+					kidvalues .clear ();
+					for (size_t k = 0; k != pd.first; ++k) { kidvalues .push_back (endkids [e.kids + k].value); }
+					value = hooks->reduced (prod, e.end->level, level, kidvalues.data(), pd.first);
+				}
+				go (e.end, pd.second, rank, tree, value);
+				if (value != 0) hooks->drop (value);
+			}
+			ends .resize (mark);
+			endkids .resize (kidmark);
+		}
+		
+		// every path depth links down from n, depth first. a step below the first pushed its link onto pathkids
+		void walk (gssnode* n, size_t depth) {
+			steps .push_back (gssstep { n, depth, 0 });
+			while (!steps.empty()) {
+				auto& s = steps.back();
+				bool done = true;
+				if (s.depth == 0) {
+					ends .push_back (gsspath { s.node, endkids.size() });
+					if (keeping_kids ()) { endkids .insert (endkids.end(), pathkids.rbegin(), pathkids.rend()); }
+				}
+				else
+				if (s.node->base) { underflow = true; }
+				else
+				if (s.next != s.node->links.size()) {
+					auto& l = s.node->links.begin() [s.next++];
+					pathkids .push_back (l);
+					steps .push_back (gssstep { l.node, s.depth - 1, 0 });
+					done = false;
+				}
+				
+				if (done) {
+					steps .pop_back ();
+					if (!steps.empty()) pathkids .pop_back ();
+				}
+			}
+		}
+		
+		void go (gssnode* below, uint32_t var, size_t rank, sppfnode* tree, uint32_t value) {
+			auto next = afsm.go (below->state, var); // column of var
+			if (next.op == 3) { go_to (next.target, below, rank, tree, value); }
+			else
+			if (next.op == 4) {
+				size_t alt = 0;
+				for (auto a : afsm.conflicts [next.target]) {
+					if (a.op == 3) { go_to (a.target, below, rank + alt, tree, value); }
+					++alt;
+				}
+			}
+		}
+		
+		void go_to (uint32_t state, gssnode* below, size_t rank, sppfnode* tree, uint32_t value) {
+			// a state that would only reduce a unit production on la is passed through, straight to the next goto
+			uint32_t made = 0;
+			for (;;) {
+				auto act = afsm.at (state, lk);
+				if (act.op != 2 || !afsm.folds [act.target]) break;
+				auto& pd = afsm.pdata [act.target];
+				auto next = afsm.go (below->state, pd.second);
+				if (next.op != 3) break;
+				
+				if (forest != nullptr) {
+					kids .assign (1, tree);
+					tree = forest->symbol (pd.second, act.target, below->level, level, kids);
+				}
+				if (hooks != nullptr) {
+					auto v = hooks->reduced (act.target, below->level, level, &value, 1);
+					if (made != 0) hooks->drop (made);
+					value = made = v;
+				}
+				state = next.target;
+			}
+			
+			gssnode* n = nullptr;
+			if (add_node (state, below, rank, tree, value, &n) && n->reduced) {
+				// the node was already reduced. only the paths through the new link are left to do
+				relinks .push_back ({ n, n->links.back() });
+			}
+			if (made != 0) hooks->drop (made);
+		}
+		
+		void shift_on (gssnode* n, action act) {
+			sppfnode* tree = nullptr;
+			uint32_t value = 0;
+			
+			switch (act.op) {
+			case 0:	errors .push_back (lrerror { level - width, (uint32_t) n->state });
+						break;
+				
+			case 1: 	if (forest != nullptr) { tree = forest->terminal (la, level - width); }
+						if (hooks != nullptr) { value = hooks->shifted (la, level - width); }
+						add_node (act.target, n, n->rank, tree, value);
+						break;
+				
+			case 4: 	{ // conflict... every shift is taken
+							size_t alt = 0;
+							for (auto a : afsm.conflicts [act.target]) {
+								if (a.op == 1) {
+									if (forest != nullptr && tree == nullptr) { tree = forest->terminal (la, level - width); }
+									if (hooks != nullptr && value == 0) { value = hooks->shifted (la, level - width); }
+									add_node (a.target, n, n->rank + alt, tree, value);
+								}
+								else
+								if (a.op == 5) { accept (n); }
+								++alt;
+							}
+						}
+						break;
+				
+			case 5: 	accept (n);
+						break;
+			}
+			if (value != 0) hooks->drop (value);
+		}
+		
+		void accept (gssnode* n) {
+			if (accepting == nullptr) { accepting = retain (n); }
+		}
+		
+		// cut the frontier down to the beam. the survivors stay in frontier order
+		void prune () {
+			auto& order = current;           // both free between steps
+			auto& keep  = work;
+			order = frontier;
+			if (policy == lr::prune::priority) {
+				std::stable_sort (order.begin(), order.end(), [](gssnode* a, gssnode* b) { return a->rank < b->rank; });
+			}
+			else {
+				std::stable_sort (order.begin(), order.end(), [](gssnode* a, gssnode* b) { return a->depth < b->depth; });
+			}
+			for (size_t i = beam; i != order.size(); ++i) { index [order[i]->state] = nullptr; }
+			
+			keep .clear ();
+			for (auto n : frontier) {
+				if (index [n->state] == n) { keep .push_back (n); }
+				else { release (n); ++pruned; }
+			}
+			frontier .swap (keep);
+			order .clear ();
+			keep .clear ();
+		}
+	};
+	
+	
+/*/// ================================================================================================================================
+	A Compiled Grammar
+	
+	Everything parsing needs: the productions, the var columns and the action table. Built once and never changed after,
+	so any number of parsers on any number of threads can share it.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	struct compiled {
+		mapfile                     file;   // the tables, when they were read in place from one
+		prods                       ps;
+		idmap                       ids;
+		std::unique_ptr <actionfsm> afsm;
+	};
+	
+	// rules named in upper case only, like the ABNF core rules, are tokens when lexing. so are the helper rules the
+	// transforms make from them, whose names only add digits
+	bool is_token (const std::string& var) {
+		bool upper = false;
+		for (size_t i = 1; i < var.size(); ++i) {
+			if (islower ((uint8_t) var[i])) return false;
+			if (isupper ((uint8_t) var[i])) upper = true;
+		}
+		return var[0] == 'V' && upper;
+	}
+	
+	// lexing, the rules that aren't tokens name the tokens they use as K words. those are terminals to the table
+	std::unique_ptr <compiled> compile (rulesview& rv, namesview& nv, bool verbose, bool lexing = false) {
+		auto cg = std::unique_ptr <compiled> (new compiled ());
+		auto& ps  = cg->ps;
+		auto& ids = cg->ids;
+		
+		{  uint32_t id = 0;
+			for (auto& i : rv) {
+				ps .emplace_back (prod (i));
+				ps.back().id = id;
+				++id;
+			}
+		}
+		
+		{
+			ids["V~S~"] = 256;
+			uint32_t id = 257;
+			for (auto& i : nv) { std::string s = "V"; s.append (i); ids[s] = id; ++id; }
+		}
+		expand_code_points (ps, ids);
+		
+		if (lexing) {
+			for (auto& p : ps) {
+				if (is_token (p.lhs)) continue;
+				for (auto& w : p.rhs) {
+					if (!is_token (w)) continue;
+					auto j = std::equal_range (ps.begin(), ps.end(), w, prcomp());
+					if (j.first != j.second) { w[0] = 'K'; }
+				}
+			}
+		}
+		
+		if (verbose) {
+			cout << ps;
+			cout << "\n\n\n";
+		}
+		
+		auto first = calculate_first_sets (ps, verbose);
+		if (verbose) {
+			cout << "Firsts\n";
+			cout << first;
+			cout << "\n\n\n";
+		}
+		
+		auto follow = calculate_follow_sets (ps, first);
+		if (verbose) {
+			cout << "Follows\n";
+			cout << follow;
+			cout << "\n\n\n";
+		}
+
+		auto items  = create_closures (ps, first, verbose);
+		if (verbose) { cout << items; }
+		
+		cg->afsm = std::unique_ptr<actionfsm> (new actionfsm (items, ps, ids, verbose));
+		
+		if (verbose) {
+			cout << "\n\n\n";
+			cout << *cg->afsm;
+			cout << "\n\n\n";
+		}
+		return cg;
+	}
+	
+	// parse one file against a compiled grammar, reporting to out. safe to run on many threads at once
+	bool parse_one (compiled& cg, const char* filename, const lr::options& opts, std::ostream& out) {
+		lrparser parser (*cg.afsm);
+		sppf forest;
+		parser .bound (opts.beam, opts.policy);
+		parser .recover_on (opts.recover);
+		if (opts.forest) { parser .build (&forest); }
+		
+		mapfile in (filename);
+		
+		// newlines are counted lazily, up to where the parser has got to
+		size_t counted = 0, line = 1;
+		auto line_at = [&](size_t pos) -> size_t {
+			pos = std::min (pos, in.size());
+			for (; counted < pos; ++counted) { if (in.beg [counted] == '\n') ++line; }
+			return line;
+		};
+		
+		if (in.good()) {
+			const uint8_t* from = in.beg;
+			
+			if (opts.resume != nullptr) {
+				std::ifstream cp (opts.resume, std::ios::binary);
+				if (opts.forest || !parser.restore (cp)) {
+					out << "Unable to resume from checkpoint " << opts.resume << "\n";
+					return false;
+				}
+				from = in.beg + std::min (parser.level, in.size());
+			}
+			
+			if (opts.save != nullptr) {
+				parser .feed (from, std::max (from, (const uint8_t*) in.beg + std::min (opts.saveat, in.size())));
+				std::ofstream cp (opts.save, std::ios::binary);
+				if (!parser.save (cp)) {
+					out << "Unable to save checkpoint " << opts.save << "\n";
+					return false;
+				}
+				out << "Saved checkpoint " << opts.save << " at byte " << parser.level << ".\n";
+				return true;
+			}
+			
+			parser .feed (from, in.end);
+			parser .finish ();
+			
+			if (parser.pruned != 0) {
+				out << "Pruned " << parser.pruned << " threads to stay within a beam of " << opts.beam << ".\n";
+			}
+			
+			if (!parser.accepted() || parser.recovered != 0) {
+				auto& errs = parser.errors;
+				for (auto e = errs.cbegin(), to = e; e != errs.cend(); e = to) {
+					to = same_position (e, errs.cend());
+					out << "Error at line " << line_at (e->at) << ": ";
+					describe (out, *cg.afsm, e, to);
+					out << "\n";
+				}
+				if (parser.recovered != 0) {
+					out << "Recovered from " << parser.recovered << " errors, skipping " << parser.skipped << " bytes.\n";
+				}
+				return false;
+			}
+			
+			if (opts.forest) {
+				auto root = parser.root ();
+				auto n = forest.count (root);
+				if (n == sppfmany) out << "At least " << n << " derivations.\n";
+				else               out << n << " derivations.\n";
+				
+				size_t shown = 0;
+				for (sppfwalk w (root); w.valid && shown != opts.show; w.next(), ++shown) {
+					w .print (out, cg.ps);
+					out << "\n";
+				}
+			}
+			return true;
+		}
+		else {
+			out << "Unable to open file " << filename << "\n";
+		}
+		return false;
+	}
+	
+	// the options that work on one target only. every worker would write the same checkpoint, or read the same one
+	strings unbatchable (const lr::options& opts) {
+		strings found;
+		if (opts.save != nullptr) found .push_back ("-save");
+		if (opts.resume != nullptr) found .push_back ("-resume");
+		if (opts.race > 1) found .push_back ("-race");
+		if (opts.ll != 0) found .push_back ("-ll");
+		if (opts.lex) found .push_back ("-lex");
+		return found;
+	}
+	
+	// parse every file against a compiled grammar on a pool of opts.jobs threads, then report each in order
+	bool parse_each (compiled& cg, const std::vector <const char*>& filenames, const lr::options& given) {
+		auto conflicts = unbatchable (given);
+		if (!conflicts.empty()) {
+			cout << conflicts.front();
+			for (size_t i = 1; i != conflicts.size(); ++i) { cout << " " << conflicts[i]; }
+			cout << " can't be used with more than one target, leaving " << (conflicts.size() == 1 ? "it" : "them") << " out.\n";
+		}
+		auto opts = given;
+		opts.save = opts.resume = nullptr;
+		opts.race = 0; opts.ll = 0; opts.lex = false;
+		
+		std::vector <std::stringstream> reports (filenames.size());
+		std::vector <char> results (filenames.size(), 0);
+		std::atomic <size_t> next (0);
+		
+		auto worker = [&]() {
+			for (size_t i = next++; i < filenames.size(); i = next++) {
+				results[i] = parse_one (cg, filenames[i], opts, reports[i]);
+			}
+		};
+		
+		size_t jobs = std::max <size_t> (1, std::min (opts.jobs, filenames.size()));
+		std::vector <std::thread> pool;
+		for (size_t j = 1; j < jobs; ++j) { pool .emplace_back (worker); }
+		worker ();
+		for (auto& t : pool) { t .join (); }
+		
+		size_t failed = 0;
+		for (size_t i = 0; i != filenames.size(); ++i) {
+			cout << filenames[i] << ": " << (results[i] ? "parsed" : "failed") << "\n";
+			cout << reports[i].str();
+			if (!results[i]) ++failed;
+		}
+		cout << (filenames.size() - failed) << " of " << filenames.size() << " files parsed.\n";
+		return failed == 0;
+	}
+	
+/*/// ================================================================================================================================
+	Table Files
+	
+	A compiled automaton written out, to be parsed against without the grammar. The file is a header, then the flat
+	arrays of the table end to end, each at a multiple of 8 bytes. Reading one maps the file and points the arrays into
+	it. Nothing is copied, so processes parsing against the same file share one copy of it in the page cache. The names
+	of the vars are the only thing read out, for the reports.
+	
+	The version changes whenever the layout does. The arrays are as they were in memory, so the header also records the
+	byte order and the sizes of a cell and a set of bytes, and a file from a machine that differs is refused. Every
+	array is checked before the parser reads any of it, for lengths that don't agree and actions that point outside.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	const char     tables_magic[4] = { 'a', 'a', 't', 'b' };
+	const uint32_t tables_version  = 1;
+	const uint32_t tables_order    = 0x01020304;
+	
+	enum tablepart {
+		tp_cells, tp_base, tp_gobase, tp_defaults, tp_colof, tp_pdata, tp_folds, tp_expects, tp_starts, tp_conflicting,
+		tp_names, tp_nameat, tableparts
+	};
+	
+	// the size of an element of each part
+	const size_t tablesizes [tableparts] = {
+		sizeof (combcell), sizeof (uint32_t), sizeof (uint32_t), sizeof (action), sizeof (uint32_t), sizeof (prodinfo),
+		sizeof (uint8_t), sizeof (bytes), sizeof (uint32_t), sizeof (action), sizeof (char), sizeof (uint32_t)
+	};
+	
+	struct tableheader {
+		char     magic [4];
+		uint32_t version;
+		uint32_t order;        // tables_order, as the writer stored it
+		uint32_t cellsize;
+		uint32_t bytesize;
+		uint32_t classes;
+		uint64_t columns;
+		struct { uint64_t offset, count; } parts [tableparts];
+	};
+	
+	bool is_tables (const uint8_t* begin, const uint8_t* end) {
+		return end - begin >= (ptrdiff_t) sizeof (tables_magic) && memcmp (begin, tables_magic, sizeof (tables_magic)) == 0;
+	}
+	
+	bool write_table (const actionfsm& afsm, std::ostream& out) {
+		// the var names end to end by column, each from where it starts to where the next does
+		strings byvar (afsm.columns - 256);
+		for (auto& v : afsm.vars) { byvar [v.second - 256] = v.first.substr (1); }
+		std::string names;
+		std::vector <uint32_t> nameat (1, 0);
+		for (auto& n : byvar) { names += n; nameat .push_back ((uint32_t) names.size()); }
+		
+		const void* from [tableparts] = {
+			afsm.cells.begin(), afsm.base.begin(), afsm.gobase.begin(), afsm.defaults.begin(), afsm.colof.begin(),
+			afsm.pdata.begin(), afsm.folds.begin(), afsm.expects.begin(), afsm.conflicts.starts.begin(),
+			afsm.conflicts.all.begin(), names.data(), nameat.data()
+		};
+		size_t counts [tableparts] = {
+			afsm.cells.size(), afsm.base.size(), afsm.gobase.size(), afsm.defaults.size(), afsm.colof.size(),
+			afsm.pdata.size(), afsm.folds.size(), afsm.expects.size(), afsm.conflicts.starts.size(),
+			afsm.conflicts.all.size(), names.size(), nameat.size()
+		};
+		
+		tableheader h;
+		memset (&h, 0, sizeof (h));
+		memcpy (h.magic, tables_magic, sizeof (tables_magic));
+		h.version = tables_version; h.order = tables_order;
+		h.cellsize = sizeof (combcell); h.bytesize = sizeof (bytes);
+		h.classes = (uint32_t) afsm.classes; h.columns = afsm.columns;
+		uint64_t at = sizeof (h);
+		for (size_t i = 0; i != tableparts; ++i) {
+			at = (at + 7) & ~uint64_t (7);
+			h.parts[i].offset = at; h.parts[i].count = counts[i];
+			at += counts[i] * tablesizes[i];
+		}
+		
+		const char zeros [8] = { };
+		out .write ((const char*) &h, sizeof (h));
+		at = sizeof (h);
+		for (size_t i = 0; i != tableparts; ++i) {
+			out .write (zeros, h.parts[i].offset - at);
+			out .write ((const char*) from[i], counts[i] * tablesizes[i]);
+			at = h.parts[i].offset + counts[i] * tablesizes[i];
+		}
+		return (bool) out;
+	}
+	
+	// the arrays agree with each other and no read the driver makes from them can go outside
+	bool sound (const actionfsm& a) {
+		size_t states = a.base.size(), vars = a.columns - 256;
+		if (states < 2 || a.gobase.size() != states || a.defaults.size() != states || a.expects.size() != states) return false;
+		if (a.classes == 0 || a.classes > 256 || a.colof.size() != a.columns || a.folds.size() != a.pdata.size()) return false;
+		for (size_t c = 0; c != a.columns; ++c) {
+			if (c < 256 ? a.colof[c] >= a.classes : a.colof[c] != c - 256 + a.classes) return false;
+		}
+		for (size_t i = 0; i != states; ++i) {
+			if (a.base[i] + a.classes > a.cells.size() || a.gobase[i] + vars > a.cells.size()) return false;
+		}
+		
+		auto& cs = a.conflicts;
+		if (cs.starts.empty() || cs.starts[0] != 0 || cs.starts [cs.starts.size() - 1] > cs.all.size()) return false;
+		for (size_t i = 1; i != cs.starts.size(); ++i) { if (cs.starts[i] < cs.starts[i-1]) return false; }
+		
+		auto fits = [&](action x, bool listed) {
+			switch (x.op) {
+				case 0: case 5:   return true;
+				case 1: case 3:   return x.target < states;
+				case 2:           return x.target < a.pdata.size();
+				case 4:           return !listed && x.target < cs.size();
+				default:          return false;
+			}
+		};
+		for (auto& c : a.cells)    { if (!fits (c.act, false)) return false; }
+		for (auto x : a.defaults)  { if (!fits (x, false)) return false; }
+		for (auto x : cs.all)      { if (!fits (x, true)) return false; }
+		for (auto& p : a.pdata)    { if (p.second < 256 || p.second >= a.columns) return false; }
+		return true;
+	}
+	
+	// null when filename isn't a table file this build can read
+	std::unique_ptr <compiled> map_table (const char* filename) {
+		auto cg = std::unique_ptr <compiled> (new compiled ());
+		auto& file = cg->file;
+		if (!file.open (filename) || file.size() < sizeof (tableheader)) return nullptr;
+		
+		auto& h = *(const tableheader*) file.beg;
+		if (!is_tables (file.beg, file.end) || h.version != tables_version || h.order != tables_order) return nullptr;
+		if (h.cellsize != sizeof (combcell) || h.bytesize != sizeof (bytes) || h.columns < 256) return nullptr;
+		for (size_t i = 0; i != tableparts; ++i) {
+			auto& pt = h.parts[i];
+			if (pt.offset % 8 != 0 || pt.offset > file.size() || pt.count > (file.size() - pt.offset) / tablesizes[i]) return nullptr;
+		}
+		auto part = [&](tablepart p) { return file.beg + h.parts[p].offset; };
+		auto count = [&](tablepart p) { return (size_t) h.parts[p].count; };
+		
+		cg->afsm = std::unique_ptr <actionfsm> (new actionfsm (cg->ps, cg->ids));
+		auto& a = *cg->afsm;
+		a.classes = h.classes;
+		a.columns = (size_t) h.columns;
+		a.width = a.classes + a.columns - 256;
+		a.cells .view ((const combcell*) part (tp_cells), count (tp_cells));
+		a.base .view ((const uint32_t*) part (tp_base), count (tp_base));
+		a.gobase .view ((const uint32_t*) part (tp_gobase), count (tp_gobase));
+		a.defaults .view ((const action*) part (tp_defaults), count (tp_defaults));
+		a.colof .view ((const uint32_t*) part (tp_colof), count (tp_colof));
+		a.pdata .view ((const prodinfo*) part (tp_pdata), count (tp_pdata));
+		a.folds .view ((const uint8_t*) part (tp_folds), count (tp_folds));
+		a.expects .view ((const bytes*) part (tp_expects), count (tp_expects));
+		a.conflicts.starts .view ((const uint32_t*) part (tp_starts), count (tp_starts));
+		a.conflicts.all .view ((const action*) part (tp_conflicting), count (tp_conflicting));
+		if (!sound (a)) return nullptr;
+		
+		// the names, the one thing read out
+		auto names = (const char*) part (tp_names);
+		auto nameat = (const uint32_t*) part (tp_nameat);
+		if (count (tp_nameat) != a.columns - 256 + 1 || nameat [a.columns - 256] > count (tp_names)) return nullptr;
+		strings byvar (a.columns - 256);
+		for (size_t v = 0; v != byvar.size(); ++v) {
+			if (nameat[v] > nameat[v+1] || nameat[v+1] > count (tp_names)) return nullptr;
+			byvar[v] = "V" + std::string (names + nameat[v], names + nameat[v+1]);
+			cg->ids [byvar[v]] = (uint32_t) (v + 256);
+		}
+		// productions by their var only, which is all a report prints
+		for (auto& p : a.pdata) {
+			cg->ps .emplace_back ();
+			cg->ps.back().lhs = byvar [p.second - 256];
+			cg->ps.back().id = (uint32_t) (cg->ps.size() - 1);
+		}
+		return cg;
+	}
+	
+/*/// ================================================================================================================================
+	Speculative Chunks
+	
+	One large input on many threads. The input is cut into a chunk per thread, each cut just after a sync byte. The first
+	chunk is parsed for real. The others are parsed at the same time from a guess: the top layers of the stacks a short
+	probe parse had just after the same byte. The chunks are then stitched in order. A chunk whose guess was wrong is
+	parsed again from where the one before it really ended, so the result is the sequential one.
+	
+	Before any thread is started the guess is tried once on a stretch of the first chunk, which the first parser
+	checks as it gets there. If it misses there it would miss on the chunks too, so the file is parsed in order.
+	
+	The sync byte is the one whose shifts lead to the fewest states, newline on a tie. A parse that fails is run again
+	sequentially so the errors reported are the sequential ones.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	const size_t speclayers = 32;     // stack layers copied into a guess
+	const size_t specprobe  = 4096;   // bytes the probe parses, at least, before it samples the stacks
+	const size_t speccheck  = 256;    // bytes, at least, between the probe and the try of the guess and through the try
+	
+	// bytes to cut after, best first
+	std::vector <uint8_t> sync_bytes (actionfsm& afsm) {
+		std::vector <std::set <uint32_t>> to (256);
+		for (size_t i = 0; i != afsm.states(); ++i) {
+			for (size_t b = 0; b != 255; ++b) {
+				auto act = afsm.act (i, b);
+				if (act.op == 1) { to[b] .insert (act.target); }
+				else
+				if (act.op == 4) {
+					for (auto a : afsm.conflicts [act.target]) { if (a.op == 1) to[b] .insert (a.target); }
+				}
+			}
+		}
+		
+		std::vector <uint8_t> order;
+		for (size_t b = 0; b != 255; ++b) { if (!to[b].empty()) order .push_back ((uint8_t) b); }
+		std::stable_sort (order.begin(), order.end(), [&](uint8_t a, uint8_t b) {
+			if (to[a].size() != to[b].size()) return to[a].size() < to[b].size();
+			return a == '\n' && b != '\n';
+		});
+		return order;
+	}
+	
+	bool parse_split (compiled& cg, const char* filename, const lr::options& opts, std::ostream& out) {
+		// forests and beams are not stitched, those parses stay sequential
+		if (opts.forest || opts.beam != 0 || opts.jobs < 2 || opts.save != nullptr || opts.resume != nullptr || opts.recover) {
+			return parse_one (cg, filename, opts, out);
+		}
+		
+		mapfile in (filename);
+		size_t n = in.size();
+		if (!in.good() || n < opts.jobs * specprobe) return parse_one (cg, filename, opts, out);
+		
+		// the probe stops after a sync byte past the first few lines, so it samples the stacks of the steady state
+		auto from  = in.beg + std::min (specprobe, n / opts.jobs / 2);
+		auto upto  = in.beg + n / opts.jobs;
+		const uint8_t* probe = nullptr;
+		uint8_t by = 0;
+		for (auto b : sync_bytes (*cg.afsm)) {
+			probe = (const uint8_t*) memchr (from, b, upto - from);
+			if (probe != nullptr) { by = b; ++probe; break; }
+		}
+		if (probe == nullptr) return parse_one (cg, filename, opts, out);
+		
+		std::vector <size_t> cuts { 0 };
+		for (size_t j = 1; j != opts.jobs; ++j) {
+			const uint8_t* at = in.beg + std::max (j * n / opts.jobs, cuts.back() + 1);
+			if (at <= probe) { at = probe + 1; }
+			if (at >= in.end) break;
+			auto q = (const uint8_t*) memchr (at, by, in.end - at);
+			if (q == nullptr || q + 1 == in.end) break;
+			cuts .push_back (q + 1 - in.beg);
+		}
+		cuts .push_back (n);
+		
+		lrparser lead (*cg.afsm);
+		lead .feed (in.beg, probe);
+		if (!lead.pending() || lead.accepted()) return parse_one (cg, filename, opts, out);
+		
+		// try the guess on the first chunk. the lead takes over the try if it was right, else it parses on alone
+		auto next_sync = [&](const uint8_t* at) -> const uint8_t* {
+			auto stop = in.beg + cuts[1];
+			auto q = at < stop ? (const uint8_t*) memchr (at, by, stop - at) : nullptr;
+			return q == nullptr || q + 1 == stop ? nullptr : q + 1;
+		};
+		auto tried = next_sync (probe + speccheck);
+		auto until = tried == nullptr ? nullptr : next_sync (tried + speccheck);
+		if (until != nullptr) {
+			lrparser trial (*cg.afsm);
+			trial .seed (lead, speclayers, tried - in.beg);
+			trial .feed (tried, until);
+			lead .feed (probe, tried);
+			if (!lead.pending() || lead.accepted() || !lead.adopt (trial)) {
+				lead .feed (tried, in.end);
+				if (!lead .finish ()) return parse_one (cg, filename, opts, out);
+				out << "Parsed in order, the guess after 0x" << std::hex << (int) by << std::dec << " was wrong.\n";
+				return true;
+			}
+			probe = until;
+		}
+		
+		std::vector <std::unique_ptr <lrparser>> specs;
+		for (size_t j = 1; j + 1 < cuts.size(); ++j) {
+			specs .emplace_back (new lrparser (*cg.afsm));
+			specs.back()->seed (lead, speclayers, cuts[j]);
+		}
+		
+		std::vector <std::thread> pool;
+		for (size_t j = 1; j + 1 < cuts.size(); ++j) {
+			auto spec = specs[j-1].get();
+			pool .emplace_back ([=, &in]() { spec->feed (in.beg + cuts[j], in.beg + cuts[j+1]); });
+		}
+		lead .feed (probe, in.beg + cuts[1]);
+		for (auto& t : pool) { t .join (); }
+		
+		size_t again = 0;
+		for (size_t j = 1; j + 1 < cuts.size() && lead.pending() && !lead.accepted(); ++j) {
+			if (!lead.adopt (*specs[j-1])) {
+				lead .feed (in.beg + cuts[j], in.beg + cuts[j+1]);
+				++again;
+			}
+			specs[j-1] .reset ();
+		}
+		
+		if (!lead .finish ()) return parse_one (cg, filename, opts, out);
+		
+		out << "Parsed in " << (cuts.size() - 1) << " chunks cut after 0x" << std::hex << (int) by << std::dec;
+		out << ", " << again << " parsed again.\n";
+		return true;
+	}
+	
+/*/// ================================================================================================================================
+	Racing Threads
+	
+	The live threads of one parse spread over a team of parsers, one per core. The team runs the same bytes a chunk at
+	a time. Between chunks the workers wait at a barrier while the first folds every thread back into itself, so
+	threads that reached the same state on different workers merge again, and then deals them out evenly. A thread
+	handed over still shares its stacks with the giver, so while threads are spread the team counts references
+	atomically. The first worker to accept stops the others.
+	
+	Handing over only pays when every worker gets a good share of the threads. Below that the first worker parses on
+	alone and the rest sit at the barrier, and with fewer cores than workers the team is cut down to the cores, down
+	to a single parser. Forests and beams are not raced.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	const size_t racechunk = 256;     // bytes between barriers
+	const size_t raceeach  = 8;       // live threads per worker it takes to spread them
+	
+	struct barrier {
+		std::mutex              m;
+		std::condition_variable cv;
+		size_t                  count;
+		size_t                  waiting = 0;
+		size_t                  round = 0;
+		
+		barrier (size_t n) : count (n) { }
+		
+		void wait () {
+			std::unique_lock <std::mutex> lock (m);
+			auto r = round;
+			if (++waiting == count) { waiting = 0; ++round; cv .notify_all (); return; }
+			cv .wait (lock, [&]() { return round != r; });
+		}
+	};
+	
+	bool parse_race (compiled& cg, const char* filename, const lr::options& opts, std::ostream& out) {
+		size_t workers = std::min (opts.race, (size_t) std::max (std::thread::hardware_concurrency(), 1u));
+		if (opts.forest || opts.beam != 0 || workers < 2 || opts.save != nullptr || opts.resume != nullptr || opts.recover) {
+			return parse_one (cg, filename, opts, out);
+		}
+		
+		mapfile in (filename);
+		if (!in.good()) return parse_one (cg, filename, opts, out);
+		
+		gsspool keep;                     // outlives the team, the nodes end up in its slabs
+		std::atomic <bool> won (false);
+		std::vector <std::unique_ptr <lrparser>> team;
+		for (size_t i = 0; i != workers; ++i) {
+			team .emplace_back (new lrparser (*cg.afsm));
+			team.back()->cancel_on (&won);
+		}
+		// the first worker starts the parse, the rest wait for threads to be handed to them
+		for (size_t i = 1; i != team.size(); ++i) { team[0]->take (team[i]->give ()); }
+		
+		const uint8_t* at = in.beg;
+		bool   stop = false;
+		size_t handed = 0;
+		barrier gate (team.size());
+		
+		auto run = [&](size_t i) {
+			auto& w = *team[i];
+			for (;;) {
+				auto upto = std::min (at + racechunk, (const uint8_t*) in.end);
+				if (w.pending()) {
+					w .feed (at, upto);
+					if (upto == in.end) { w .finish (); }
+					if (w.accepted()) { won = true; }
+				}
+				gate .wait ();
+				
+				if (i == 0) {
+					at = upto;
+					stop = won || at == in.end;
+					
+					// fold the threads back in, those in the same state merge. then deal them out if there are enough
+					if (!stop) {
+						for (size_t k = 1; k != team.size(); ++k) {
+							while (team[k]->threads() != 0) { w .take (team[k]->give ()); }
+						}
+						size_t total = w.threads();
+						stop = total == 0;
+						
+						bool spread = total >= raceeach * team.size();
+						for (auto& t : team) { t->pool.shared = spread; }
+						for (size_t k = 1; spread && k != team.size(); ++k) {
+							for (size_t j = 0; j != total / team.size(); ++j) { team[k]->take (w.give ()); ++handed; }
+						}
+					}
+				}
+				gate .wait ();
+				if (stop) return;
+			}
+		};
+		
+		std::vector <std::thread> pool;
+		for (size_t i = 1; i != team.size(); ++i) { pool .emplace_back (run, i); }
+		run (0);
+		for (auto& t : pool) { t .join (); }
+		
+		bool accepted = false;
+		for (auto& t : team) { accepted = accepted || t->accepted(); keep .merge (t->pool); }
+		
+		// the errors reported are the ones a single parser finds
+		if (!accepted) return parse_one (cg, filename, opts, out);
+		
+		out << "Raced on " << team.size() << " workers, " << handed << " threads handed over.\n";
+		return true;
+	}
+	
+/*/// ================================================================================================================================
+	Incremental Parsing
+	
+	For editors. A document keeps its text, the outcome of its last parse and a snapshot of the stacks every so many
+	bytes. After an edit the parse restarts from the last snapshot before the change, and runs until its stacks match
+	those of an old snapshot past the change, state for state, with the same text left to read. From there on the old
+	parse still holds, so its later snapshots and its outcome are kept. The work depends on the size of the edit plus
+	twice the distance between snapshots, not on the size of the document. Snapshots copy only the top nodes, the
+	stacks below are shared, so they are taken often.
+	
+	Nodes kept from the old parse still carry their old positions. Forests are not kept.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	const size_t snapevery = 64;      // bytes between snapshots
+	
+	struct lrsnap {
+		size_t   at;                  // bytes of the text parsed
+		gssnodes tops;                // held by the snapshot
+	};
+	using lrsnaps = std::vector <lrsnap>;
+	
+	// true when two sets of stacks are the same state for state. stops going down where they share nodes, gives up where
+	// their depths differ
+	bool same_stacks (const gssnodes& a, const gssnodes& b) {
+		if (a.size() != b.size()) return false;
+		
+		std::map <gssnode*, gssnode*> seen;
+		std::vector <std::pair <gssnode*, gssnode*>> todo;
+		for (auto n : a) {
+			auto m = std::find_if (b.begin(), b.end(), [&](gssnode* k) { return k->state == n->state; });
+			if (m == b.end()) return false;
+			todo .push_back ({ n, *m });
+		}
+		
+		while (!todo.empty()) {
+			auto x = todo.back().first, y = todo.back().second;
+			todo .pop_back ();
+			if (x == y) continue;
+			if (x->state != y->state || x->depth != y->depth || x->links.size() != y->links.size()) return false;
+			
+			auto s = seen.find (x);
+			if (s != seen.end()) { if (s->second != y) return false; continue; }
+			seen [x] = y;
+			
+			for (auto& l : x->links) {
+				gssnode* match = nullptr;
+				for (auto& k : y->links) { if (k.node == l.node) match = k.node; }
+				if (match == nullptr) {
+					for (auto& k : y->links) {
+						if (k.node->state != l.node->state) continue;
+						if (match != nullptr) return false;
+						match = k.node;
+					}
+				}
+				if (match == nullptr) return false;
+				todo .push_back ({ l.node, match });
+			}
+		}
+		return true;
+	}
+	
+	struct lrdocument {
+		std::unique_ptr <compiled> cg;
+		gsspool     pool;             // lent to each parser, so the nodes it leaves in snapshots outlive it
+		std::string text;
+		lrsnaps     snaps;
+		bool        accepted = false;
+		size_t      reparsed = 0;     // bytes run through the parser by the last load or edit
+		
+		lrdocument (rulesview& rv, namesview& nv) : cg (compile (rv, nv, false)) { }
+		~lrdocument () { for (auto& s : snaps) drop (s); }
+		
+		void drop (lrsnap& s) {
+			for (auto n : s.tops) { pool .release (n); }
+			s.tops .clear ();
+		}
+		
+		bool load (const std::string& t) {
+			for (auto& s : snaps) drop (s);
+			snaps .clear ();
+			text = t;
+			lrsnaps none;
+			return reparse (none);
+		}
+		
+		// replace erase bytes at at with insert
+		bool edit (size_t at, size_t erase, const std::string& insert) {
+			at = std::min (at, text.size());
+			erase = std::min (erase, text.size() - at);
+			text .replace (at, erase, insert);
+			
+			// the snapshots up to the edit still hold. the ones after it might, once their positions are moved
+			lrsnaps old;
+			size_t keep = 0;
+			while (keep != snaps.size() && snaps[keep].at <= at) ++keep;
+			for (size_t i = keep; i != snaps.size(); ++i) {
+				if (snaps[i].at >= at + erase) {
+					old .push_back (lrsnap { snaps[i].at - erase + insert.size(), std::move (snaps[i].tops) });
+				}
+				else drop (snaps[i]);
+			}
+			snaps .resize (keep);
+			return reparse (old);
+		}
+		
+		bool reparse (lrsnaps& old) {
+			lrparser p (*cg->afsm);
+			p .clear ();
+			p.pool = std::move (pool);
+			run (p, old);
+			p .clear ();
+			pool = std::move (p.pool);
+			return accepted;
+		}
+		
+		// parse on from the last snapshot, taking new ones. stops early once the stacks match one of the old snapshots
+		void run (lrparser& p, lrsnaps& old) {
+			bool was = accepted;
+			auto beg = (const uint8_t*) text.data();
+			size_t at = 0, end = text.size(), c = 0;
+			
+			if (snaps.empty()) {
+				lrparser fresh (*cg->afsm);
+				p .start_from (fresh.frontier, 0);
+				snaps .push_back (lrsnap { 0, p.snapshot () });
+			}
+			else {
+				at = snaps.back().at;
+				p .start_from (snaps.back().tops, at);
+			}
+			reparsed = 0;
+			
+			while (at != end && p.pending()) {
+				while (c != old.size() && old[c].at <= at) drop (old[c++]);
+				size_t stop = std::min (at + snapevery, end);
+				if (c != old.size()) stop = std::min (stop, old[c].at);
+				
+				p .feed (beg + at, beg + stop);
+				reparsed += stop - at;
+				at = stop;
+				if (!p.pending()) break;
+				
+				if (c != old.size() && old[c].at == at && same_stacks (p.frontier, old[c].tops)) {
+					// the old parse holds from here on
+					for (; c != old.size(); ++c) { snaps .push_back (std::move (old[c])); }
+					accepted = was;
+					return;
+				}
+				if (at != end) snaps .push_back (lrsnap { at, p.snapshot () });
+			}
+			
+			for (; c != old.size(); ++c) drop (old[c]);
+			accepted = p .finish ();
+		}
+	};
+	
+/*/// ================================================================================================================================
+	Predictive Parsing
+	
+	Many grammars need no GLR at all. Where every rule can pick its alternative from the next k bytes, a predictive
+	parser does the job with one stack of (production, position) pairs and no tables beyond the lookahead sets.
+	
+	The sets are the FIRST and FOLLOW sets of the LR construction taken down to bytes and out to k of them, the linear
+	approximation: for each depth under k, the bytes that can appear there. Alternatives with a common prefix are left
+	factored first. A rule is then LL(d) when every two of its alternatives have some depth under d where their sets
+	don't meet, so at most one alternative matches the input at every depth. Left recursive rules never are. The last symbol of a production is taken once its frame is popped, so
+	right recursion runs in constant stack.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	const size_t   llmax  = 8;             // deepest lookahead tried
+	const uint32_t llnone = ~0u;           // no production fits
+	
+	// what the strings derived from some symbols look like through k bytes of lookahead
+	struct llsets {
+		bytes    at [llmax];       // the bytes that can be seen at each depth
+		uint32_t lens = 0;         // bit n set when the strings can be n bytes long, for n under k
+		
+		bool merge (const llsets& o, size_t k) {
+			bool grew = (lens | o.lens) != lens;
+			lens |= o.lens;
+			for (size_t d = 0; d != k; ++d) {
+				auto was = at[d];
+				at[d] |= o.at[d];
+				if (at[d] != was) grew = true;
+			}
+			return grew;
+		}
+		
+		// these strings followed by the ones next stands for
+		void then (const llsets& next, size_t k) {
+			uint32_t more = 0;
+			for (size_t p = 0; p != k; ++p) {
+				if ((lens & (1u << p)) == 0) continue;
+				for (size_t d = 0; p + d != k; ++d) { at [p + d] |= next.at [d]; }
+				more |= (next.lens << p) & ((1u << k) - 1);
+			}
+			lens = more;
+		}
+	};
+	
+	struct llgrammar {
+		compiled&  cg;
+		size_t     k;
+		std::vector <std::vector <int32_t>>  rhs;      // per production, vars as their index and terminals as ~index
+		std::vector <bytes>                  terms;
+		std::vector <uint32_t>               lhs;      // per production
+		std::vector <std::vector <uint32_t>> alts;     // per var, its productions
+		strings                              names;    // per var
+		std::vector <llsets>                 first;    // per var
+		std::vector <llsets>                 follow;   // per var
+		std::vector <llsets>                 predict;  // per production, its rhs then the follow of its var
+		std::vector <size_t>                 depth;    // per var, the lookahead it needs. 0 if it is not LL(k)
+		std::vector <std::array <uint32_t, 256>> pick1;   // per var, the production for each byte, for rules that need 1
+		strings    problems;
+		uint32_t   start = 0;
+		
+		llgrammar (compiled& c, size_t kk) : cg (c), k (std::min (std::max <size_t> (kk, 1), llmax)) {
+			alts .resize (cg.ids.size());
+			names .resize (cg.ids.size());
+			for (auto& i : cg.ids) { names [i.second - 256] = i.first.substr (1); }
+			
+			std::map <std::string, int32_t> termids;
+			for (auto& p : cg.ps) {
+				if (p.lhs == "V~S~") continue;
+				std::vector <int32_t> r;
+				for (auto& w : p.rhs) {
+					if (!isterminal (w)) { r .push_back ((int32_t) var_of (w)); continue; }
+					if (w[0] == 'K') { r .push_back ((int32_t) var_of ("V" + w.substr (1))); continue; }   // a token, as its rule
+					auto t = termids .find (w);
+					if (t == termids.end()) {
+						t = termids .insert ({ w, (int32_t) terms.size() }).first;
+						terms .push_back (bytes_of (w));
+					}
+					r .push_back (~t->second);
+				}
+				add (var_of (p.lhs), r);
+			}
+			start = var_of ("Vstart");
+			factor ();
+			
+			first .resize (alts.size());
+			follow .resize (alts.size());
+			depth .resize (alts.size(), 0);
+			
+			// first sets, then follow sets, each to a fixed point
+			for (bool grew = true; grew; ) {
+				grew = false;
+				for (size_t p = 0; p != rhs.size(); ++p) {
+					if (first [lhs[p]] .merge (sets_of (rhs[p], 0), k)) grew = true;
+				}
+			}
+			
+			for (size_t d = 0; d != k; ++d) follow [start].at[d] .set (0xff);
+			for (bool grew = true; grew; ) {
+				grew = false;
+				for (size_t p = 0; p != rhs.size(); ++p) {
+					auto& r = rhs[p];
+					for (size_t i = 0; i != r.size(); ++i) {
+						if (r[i] < 0) continue;
+						auto rest = sets_of (r, i + 1);
+						rest .then (follow [lhs[p]], k);
+						if (follow [r[i]] .merge (rest, k)) grew = true;
+					}
+				}
+			}
+			
+			for (size_t p = 0; p != rhs.size(); ++p) {
+				predict .push_back (sets_of (rhs[p], 0));
+				predict.back() .then (follow [lhs[p]], k);
+			}
+			
+			decide ();
+		}
+		
+		uint32_t var_of (const std::string& v) {
+			auto i = cg.ids .find (v);
+			return (i == cg.ids.end()) ? 0 : i->second - 256;
+		}
+		
+		void add (uint32_t v, const std::vector <int32_t>& r) {
+			rhs .push_back (r);
+			lhs .push_back (v);
+			alts [v] .push_back ((uint32_t) (rhs.size() - 1));
+		}
+		
+		// alternatives that start alike are kept as one up to where they part, and the rest goes to a new var. the
+		// front end writes repetition as item / item more, which no lookahead can tell apart until it is factored
+		void factor () {
+			for (uint32_t v = 0; v != alts.size(); ++v) {
+				for (bool again = true; again; ) {
+					again = false;
+					for (size_t i = 0; i != alts[v].size() && !again; ++i) {
+						auto& ri = rhs [alts[v][i]];
+						if (ri.empty()) continue;
+						
+						std::vector <uint32_t> alike, rest;
+						for (auto p : alts[v]) { (!rhs[p].empty() && rhs[p][0] == ri[0] ? alike : rest) .push_back (p); }
+						if (alike.size() < 2) continue;
+						
+						size_t common = ri.size();
+						for (auto p : alike) {
+							size_t n = 0;
+							while (n != common && n != rhs[p].size() && rhs[p][n] == ri[n]) ++n;
+							common = n;
+						}
+						
+						uint32_t w = (uint32_t) alts.size();
+						alts .emplace_back ();
+						names .push_back (names[v] + "'");
+						std::vector <int32_t> head (ri.begin(), ri.begin() + common);
+						head .push_back ((int32_t) w);
+						for (auto p : alike) {
+							rhs[p] .erase (rhs[p].begin(), rhs[p].begin() + common);
+							lhs[p] = w;
+							alts[w] .push_back (p);
+						}
+						alts[v] = rest;
+						add (v, head);
+						again = true;
+					}
+				}
+			}
+		}
+		
+		// the sets for r from position from on
+		llsets sets_of (const std::vector <int32_t>& r, size_t from) {
+			llsets s;
+			s.lens = 1;
+			for (auto i = from; i != r.size() && s.lens != 0; ++i) {
+				if (r[i] >= 0) { s .then (first [r[i]], k); continue; }
+				llsets t;
+				t.at[0] = terms [~r[i]];
+				t.lens = (k > 1) ? 2 : 0;
+				s .then (t, k);
+			}
+			return s;
+		}
+		
+		// the lookahead each rule needs, and which rules can't be predicted at all
+		void decide () {
+			auto lr = left_recursive ();
+			pick1 .resize (alts.size());
+			
+			for (uint32_t v = 0; v != alts.size(); ++v) {
+				auto& as = alts[v];
+				if (as.empty()) continue;
+				if (lr[v]) { problems .push_back ("Rule " + names [v] + " is left recursive."); continue; }
+				
+				size_t need = 1;
+				for (size_t i = 0; i != as.size(); ++i) {
+					for (size_t j = i + 1; j != as.size(); ++j) {
+						size_t d = 0;
+						while (d != k && (predict [as[i]].at[d] & predict [as[j]].at[d]).any()) ++d;
+						if (d == k) {
+							std::stringstream ss;
+							ss << "Rule " << names [v] << " is not LL(" << k << "): alternatives " << i + 1 << " and " << j + 1;
+							ss << " can't be told apart.";
+							problems .push_back (ss.str());
+							need = 0;
+							break;
+						}
+						need = std::max (need, d + 1);
+					}
+					if (need == 0) break;
+				}
+				depth[v] = need;
+				
+				if (need == 1) {
+					pick1[v] .fill (llnone);
+					for (auto p : as) {
+						for (size_t c = 0; c != 256; ++c) { if (predict[p].at[0][c]) pick1[v][c] = p; }
+					}
+				}
+			}
+		}
+		
+		// vars that can derive a string starting with themselves
+		std::vector <bool> left_recursive () {
+			std::vector <std::vector <uint32_t>> leads (alts.size());
+			for (size_t p = 0; p != rhs.size(); ++p) {
+				for (auto x : rhs[p]) {
+					if (x < 0) break;
+					leads [lhs[p]] .push_back ((uint32_t) x);
+					if ((first[x].lens & 1) == 0) break;
+				}
+			}
+			
+			std::vector <bool> lr (alts.size(), false);
+			for (uint32_t v = 0; v != alts.size(); ++v) {
+				std::vector <bool> seen (alts.size(), false);
+				std::vector <uint32_t> todo (leads[v]);
+				while (!todo.empty() && !lr[v]) {
+					auto x = todo.back(); todo .pop_back ();
+					if (x == v) lr[v] = true;
+					if (seen[x]) continue;
+					seen[x] = true;
+					todo .insert (todo.end(), leads[x].begin(), leads[x].end());
+				}
+			}
+			return lr;
+		}
+		
+		inline bool predictive () { return problems.empty(); }
+		
+		// the production for var v that the input at la can start with, or none
+		uint32_t pick (uint32_t v, const uint8_t* la, const uint8_t* end) {
+			auto& as = alts[v];
+			if (as.size() == 1) return as[0];
+			if (depth[v] == 1) return pick1[v][la < end ? *la : 0xff];
+			for (auto p : as) {
+				size_t d = 0;
+				for (; d != depth[v]; ++d) {
+					uint8_t ch = (la + d < end) ? la[d] : 0xff;
+					if (!predict[p].at[d][ch]) break;
+				}
+				if (d == depth[v]) return p;
+			}
+			return llnone;
+		}
+		
+		bytes expected (uint32_t v) {
+			bytes b;
+			for (auto p : alts[v]) b |= predict[p].at[0];
+			return b;
+		}
+	};
+	
+	// parse a whole buffer with a predictive grammar. on failure, where it stopped and what it wanted there
+	bool parse_ll (llgrammar& g, const uint8_t* beg, const uint8_t* end, size_t& at, bytes& wanted) {
+		struct frame { uint32_t prod; uint32_t dot; };
+		std::vector <frame> stack;
+		
+		auto la = beg;
+		auto p = g .pick (g.start, la, end);
+		if (p == llnone) { at = 0; wanted = g .expected (g.start); return false; }
+		stack .push_back (frame { p, 0 });
+		
+		while (!stack.empty()) {
+			auto& f = stack.back();
+			auto& r = g.rhs [f.prod];
+			if (f.dot == r.size()) { stack .pop_back (); continue; }
+			auto x = r [f.dot++];
+			if (f.dot == r.size()) stack .pop_back ();     // nothing left to come back to
+			
+			if (x < 0) {
+				if (la == end || !g.terms [~x][*la]) { at = la - beg; wanted = g.terms [~x]; return false; }
+				++la;
+			}
+			else {
+				auto q = g .pick ((uint32_t) x, la, end);
+				if (q == llnone) { at = la - beg; wanted = g .expected ((uint32_t) x); return false; }
+				if (!g.rhs[q].empty()) stack .push_back (frame { q, 0 });
+			}
+		}
+		
+		if (la != end) { at = la - beg; wanted .reset (); wanted .set (0xff); return false; }
+		return true;
+	}
+	
+	// check the grammar is LL(opts.ll) and parse with it. false in used when it isn't, so the caller can fall back
+	bool parse_predictive (compiled& cg, const char* filename, const lr::options& opts, std::ostream& out, bool& used) {
+		llgrammar g (cg, opts.ll);
+		for (auto& i : g.problems) { out << i << "\n"; }
+		used = g .predictive ();
+		if (!used) return false;
+		
+		mapfile in (filename);
+		if (!in.good()) return false;
+		
+		size_t at = 0;
+		bytes wanted;
+		if (parse_ll (g, in.beg, in.end, at, wanted)) return true;
+		
+		size_t line = 1;
+		for (size_t i = 0; i != at; ++i) { if (in.beg[i] == '\n') ++line; }
+		out << "Error at line " << line << ": ";
+		describe (out, wanted);
+		out << "\n";
+		return false;
+	}
+	
+/*/// ================================================================================================================================
+	Lexing
+	
+	Scannerless, every byte of an identifier is a step of the GLR driver, and so is every reduction of the right
+	recursive helpers its repetition was expanded into. With a lexer the rules named in upper case are tokens. They are
+	compiled to one DFA that runs ahead of the parser, and the table sees each token as a single terminal in the column
+	of its rule.
+	
+	A token's rules are turned into an NFA a var at a time, for each place the var continues to. A var reached again
+	while it is being built with the same continuation is right recursion, the NFA loops back. Reached with another one
+	the token isn't regular and can't be lexed. The NFA is then made a DFA by subset construction.
+	
+	The scan takes the longest token at each position that some live thread can take. Tokens that match the same bytes
+	go to the one that ends in the fewest states of the DFA, the most specific, so a keyword wins over an identifier.
+	When no live thread takes any token that matches, the byte goes to the parser on its own, for the literals of the
+	rules that aren't tokens.
+	
+	That only reads the grammar's language if a token never runs on into a byte that can follow it, and no place in
+	the grammar reads both a token and a byte it can start with. Grammars that break either rule are reported and
+	parsed without the lexer.
+	
+	A repetition of a class of bytes becomes a DFA state that loops on the class, *VCHAR on R0021007E say. The scan
+	runs over those a vector at a time with AVX2 or SSSE3, whichever the processor has, and a byte at a time where it has
+	neither. Both are compiled in on x86 whatever the build targets, and the first scan picks one.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	// a set of bytes the scan runs over sixteen or thirty two at a time. a byte is split into its nibbles, and a table
+	// indexed by the low one holds a bit for each high one. shuffles look up a whole vector of bytes at once
+	struct byterun {
+		alignas (16) uint8_t low [16];    // high nibbles 0-7
+		alignas (16) uint8_t high [16];   // high nibbles 8-f
+		bytes in;
+		
+		explicit byterun (const bytes& b) : in (b) {
+			memset (low, 0, sizeof (low));
+			memset (high, 0, sizeof (high));
+			for (size_t c = 0; c != 256; ++c) {
+				if (!b [c]) continue;
+				if (c < 0x80) low [c & 0xf] |= 1 << (c >> 4);
+				else          high [c & 0xf] |= 1 << ((c >> 4) - 8);
+			}
+		}
+		
+		// the first byte from p on that isn't in the set, or end
+		const uint8_t* skip (const uint8_t* p, const uint8_t* end) const {
+#if defined (aa_x86_vectors)
+			static const int width = __builtin_cpu_supports ("avx2") ? 32 : __builtin_cpu_supports ("ssse3") ? 16 : 1;
+			if (width == 32) { p = skip32 (p, end); }
+			else
+			if (width == 16) { p = skip16 (p, end); }
+#endif
+			while (p != end && in [*p]) ++p;
+			return p;
+		}
+		
+#if defined (aa_x86_vectors)
+		// the same, as far as whole vectors go. stops at the first byte outside the set, or short of end
+		__attribute__ ((target ("avx2")))
+		const uint8_t* skip32 (const uint8_t* p, const uint8_t* end) const {
+			const auto lo   = _mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i*) low));
+			const auto hi   = _mm256_broadcastsi128_si256 (_mm_load_si128 ((const __m128i*) high));
+			const auto bits = _mm256_setr_epi8 (1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+			                                    1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const auto nib  = _mm256_set1_epi8 (0x0f);
+			const auto flip = _mm256_set1_epi8 (-128);
+			for (; end - p >= 32; p += 32) {
+				auto v = _mm256_loadu_si256 ((const __m256i*) p);
+				auto t = _mm256_or_si256 (_mm256_shuffle_epi8 (lo, v), _mm256_shuffle_epi8 (hi, _mm256_xor_si256 (v, flip)));
+				auto b = _mm256_shuffle_epi8 (bits, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nib));
+				auto out = (uint32_t) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_and_si256 (t, b), _mm256_setzero_si256 ()));
+				if (out != 0) return p + __builtin_ctz (out);
+			}
+			return p;
+		}
+		
+		__attribute__ ((target ("ssse3")))
+		const uint8_t* skip16 (const uint8_t* p, const uint8_t* end) const {
+			const auto lo   = _mm_load_si128 ((const __m128i*) low);
+			const auto hi   = _mm_load_si128 ((const __m128i*) high);
+			const auto bits = _mm_setr_epi8 (1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const auto nib  = _mm_set1_epi8 (0x0f);
+			const auto flip = _mm_set1_epi8 (-128);
+			for (; end - p >= 16; p += 16) {
+				auto v = _mm_loadu_si128 ((const __m128i*) p);
+				auto t = _mm_or_si128 (_mm_shuffle_epi8 (lo, v), _mm_shuffle_epi8 (hi, _mm_xor_si128 (v, flip)));
+				auto b = _mm_shuffle_epi8 (bits, _mm_and_si128 (_mm_srli_epi16 (v, 4), nib));
+				auto out = (uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (t, b), _mm_setzero_si128 ()));
+				if (out != 0) return p + __builtin_ctz (out);
+			}
+			return p;
+		}
+#endif
+	};
+	
+	struct lexer {
+		std::vector <std::array <uint32_t, 256>> next;  // state and byte -> state, 0 for none. the scan starts in 1
+		std::vector <std::vector <uint32_t>>     ends;  // per state, the columns of the tokens that end there
+		std::vector <uint32_t>                   loops; // per state, 1 + the run it loops on, 0 for none
+		std::vector <byterun>                    runs;
+		strings                                  names; // per column, the token's name
+		strings                                  problems;
+		
+		explicit lexer (compiled& cg) : names (256 + cg.ids.size()) {
+			auto& ps = cg.ps;
+			auto& ids = cg.ids;
+			for (auto& p : ps) {
+				for (auto& w : p.rhs) {
+					if (w[0] != 'K') continue;
+					auto col = ids ["V" + w.substr (1)];
+					if (names [col].empty()) { names [col] = w.substr (1); }
+				}
+			}
+			
+			// nfa state 0 starts every token
+			nfa .resize (1);
+			for (size_t col = 256; col != names.size(); ++col) {
+				if (names [col].empty()) continue;
+				auto to = add ();
+				nfa [to].ends = (uint32_t) col;
+				good = true;
+				auto from = build (ps, "V" + names [col], to);
+				if (good) { nfa [0].skip .push_back (from); }
+				else      { problems .push_back ("Token " + names [col] + " isn't regular, it can't be lexed."); }
+			}
+			determine ();
+			nfa .clear ();
+			
+			loops .resize (next.size());
+			for (size_t s = 1; s != next.size(); ++s) {
+				bytes self;
+				for (size_t b = 0; b != 256; ++b) { if (next [s][b] == s) self .set (b); }
+				if (self.none()) continue;
+				runs .emplace_back (self);
+				loops [s] = (uint32_t) runs.size();
+			}
+			
+			if (problems.empty()) { overlaps (cg); }
+		}
+		
+		// the length of the longest token at p that takes says some live thread can read, and its column through col.
+		// 0 when there is none, and the byte at p is read as itself
+		template <typename Takes>
+		size_t match (const uint8_t* p, const uint8_t* end, uint32_t& col, Takes takes) const {
+			hits .clear ();
+			size_t len = 0;
+			for (uint32_t s = 1; p + len != end; ) {
+				s = next [s][p [len++]];
+				if (s == 0) break;
+				if (loops [s] != 0) { len = runs [loops [s] - 1] .skip (p + len, end) - p; }
+				if (ends [s].empty()) continue;
+				// a run ends a token all along it, and no shorter stretch of it is read any other way
+				if (!hits.empty() && hits.back().second == s) { hits.back().first = len; }
+				else { hits .push_back ({ len, s }); }
+			}
+			for (auto h = hits.rbegin(); h != hits.rend(); ++h) {
+				for (auto c : ends [h->second]) { if (takes (c)) { col = c; return h->first; } }
+			}
+			return 0;
+		}
+		
+	private:
+		struct nstate {
+			std::vector <std::pair <bytes, uint32_t>> on;   // bytes -> state
+			std::vector <uint32_t>                    skip; // empty moves
+			uint32_t                                  ends = 0;
+		};
+		
+		std::vector <nstate> nfa;
+		std::map <std::pair <std::string, uint32_t>, uint32_t> built;   // var and its continuation -> where it starts
+		mutable std::vector <std::pair <size_t, uint32_t>> hits;          // scratch for match, where tokens end and in which state
+		std::set <std::string> building;
+		bool good = true;
+		
+		uint32_t add () { nfa .emplace_back (); return (uint32_t) nfa.size() - 1; }
+		
+		// the start of an nfa for var followed by whatever then
+		uint32_t build (prods& ps, const std::string& var, uint32_t then) {
+			auto f = built .find ({ var, then });
+			if (f != built.end()) return f->second;
+			if (building.count (var) != 0) { good = false; return add (); }
+			
+			auto start = add ();
+			built [{ var, then }] = start;
+			building .insert (var);
+			auto j = std::equal_range (ps.begin(), ps.end(), var, prcomp());
+			for (auto k = j.first; k != j.second; ++k) {
+				auto at = then;
+				for (auto w = k->rhs.rbegin(); w != k->rhs.rend(); ++w) {
+					if (w->at (0) == 'V' || w->at (0) == 'K') { at = build (ps, "V" + w->substr (1), at); continue; }
+					auto s = add ();
+					nfa [s].on .push_back ({ bytes_of (*w), at });
+					at = s;
+				}
+				nfa [start].skip .push_back (at);
+			}
+			building .erase (var);
+			return start;
+		}
+		
+		void close (std::vector <uint32_t>& set) {
+			for (size_t i = 0; i != set.size(); ++i) {
+				for (auto s : nfa [set[i]].skip) {
+					if (std::find (set.begin(), set.end(), s) == set.end()) set .push_back (s);
+				}
+			}
+			std::sort (set.begin(), set.end());
+		}
+		
+		// longest match reads a different language from the grammar in two cases. a token can run on into a byte that
+		// can follow it, so the parser never sees that byte. or a place in the grammar reads both a token and a byte
+		// the token can start with, so the byte is never read as itself. in either case the parser reads the bytes.
+		// where the table has conflicts, threads in different states read the same input, so a byte read anywhere counts
+		void overlaps (compiled& cg) {
+			llgrammar g (cg, 1);
+			auto& afsm = *cg.afsm;
+			auto name = [](size_t c) { std::stringstream ss; describe_byte (ss, c); return ss.str(); };
+			
+			// the tokens each dfa state can still end
+			std::vector <std::set <uint32_t>> reach (next.size());
+			for (bool grew = true; grew; ) {
+				grew = false;
+				for (size_t d = next.size() - 1; d != 0; --d) {
+					auto was = reach[d].size();
+					reach[d] .insert (ends[d].begin(), ends[d].end());
+					for (size_t b = 0; b != 0xff; ++b) {
+						auto& to = reach [next[d][b]];
+						if (next[d][b] != 0) reach[d] .insert (to.begin(), to.end());
+					}
+					if (reach[d].size() != was) grew = true;
+				}
+			}
+			
+			bool forks = false;
+			for (size_t st = 0; st != afsm.states() && !forks; ++st) {
+				for (size_t col = 0; col != afsm.columns && !forks; ++col) { forks = afsm.act (st, col).op == 4; }
+			}
+			
+			for (size_t col = 256; col != names.size(); ++col) {
+				if (names [col].empty()) continue;
+				
+				auto& follow = g.follow [g.var_of ("V" + names [col])].at[0];
+				bool found = false;
+				for (size_t d = 1; d != next.size() && !found; ++d) {
+					if (std::find (ends[d].begin(), ends[d].end(), col) == ends[d].end()) continue;
+					for (size_t b = 0; b != 0xff && !found; ++b) {
+						if (next[d][b] == 0 || !follow[b]) continue;
+						problems .push_back ("Token " + names [col] + " can run on into the " + name (b) + " that can follow it, it can't be lexed.");
+						found = true;
+					}
+				}
+				
+				bytes first;
+				for (size_t b = 0; b != 0xff; ++b) { if (next[1][b] != 0 && reach [next[1][b]].count (col) != 0) first .set (b); }
+				for (size_t st = 0; st != afsm.states() && !found; ++st) {
+					if (!forks && afsm.act (st, col).op == 0) continue;
+					for (size_t b = 0; b != 0xff && !found; ++b) {
+						if (!first[b] || afsm.act (st, b).op == 0) continue;
+						problems .push_back ("Token " + names [col] + " and the " + name (b) + " it starts with can both be read in one place, it can't be lexed.");
+						found = true;
+					}
+				}
+			}
+		}
+		
+		// subset construction. 0xff is the end of the input to the parser, so no token takes it
+		void determine () {
+			std::map <std::vector <uint32_t>, uint32_t> number;
+			std::vector <std::vector <uint32_t>> sets (2);
+			sets [1] = { 0 };
+			close (sets [1]);
+			number [sets [1]] = 1;
+			next .resize (2);
+			ends .resize (2);
+			
+			for (size_t d = 1; d != sets.size(); ++d) {
+				for (auto s : sets [d]) {
+					if (nfa [s].ends != 0 && std::find (ends [d].begin(), ends [d].end(), nfa [s].ends) == ends [d].end()) {
+						ends [d] .push_back (nfa [s].ends);
+					}
+				}
+				
+				for (size_t b = 0; b != 0xff; ++b) {
+					std::vector <uint32_t> to;
+					for (auto s : sets [d]) {
+						for (auto& e : nfa [s].on) {
+							if (e.first [b] && std::find (to.begin(), to.end(), e.second) == to.end()) to .push_back (e.second);
+						}
+					}
+					if (to.empty()) continue;
+					close (to);
+					auto n = number .find (to);
+					if (n == number.end()) {
+						n = number .insert ({ to, (uint32_t) sets.size() }).first;
+						sets .push_back (to);
+						next .emplace_back ();
+						ends .emplace_back ();
+					}
+					next [d][b] = n->second;
+				}
+			}
+			
+			// most specific first
+			std::map <uint32_t, size_t> states;
+			for (auto& e : ends) { for (auto c : e) ++states [c]; }
+			for (auto& e : ends) {
+				std::sort (e.begin(), e.end(), [&](uint32_t a, uint32_t b) {
+					return states [a] != states [b] ? states [a] < states [b] : a < b;
+				});
+			}
+		}
+	};
+	
+	// the tokens a state of a lexed parse wanted, then its bytes
+	void describe (std::ostream& out, const actionfsm& afsm, const lexer& lx, lrerrors::const_iterator from, lrerrors::const_iterator to) {
+		strings tokens;
+		std::bitset <256> want;
+		for (size_t col = 256; col < afsm.columns; ++col) {
+			if (lx.names [col].empty()) continue;
+			for (auto e = from; e != to; ++e) {
+				if (afsm.act (e->state, col).op != 0) { tokens .push_back (lx.names [col]); break; }
+			}
+		}
+		for (auto e = from; e != to; ++e) { want |= afsm.expects [e->state]; }
+		describe (out, want, tokens);
+	}
+	
+	// the options set that a lexed parse doesn't honour, as they are given on the command line
+	strings unlexable (const lr::options& opts) {
+		strings found;
+		if (opts.forest) found .push_back ("-forest");
+		if (opts.save != nullptr) found .push_back ("-save");
+		if (opts.resume != nullptr) found .push_back ("-resume");
+		if (opts.jobs > 1) found .push_back ("--jobs");
+		if (opts.race > 1) found .push_back ("-race");
+		if (opts.ll != 0) found .push_back ("-ll");
+		return found;
+	}
+	
+	bool parse_lexed (compiled& cg, const lexer& lx, const char* filename, const lr::options& opts, std::ostream& out) {
+		lrparser parser (*cg.afsm);
+		parser .bound (opts.beam, opts.policy);
+		parser .recover_on (opts.recover);
+		
+		mapfile in (filename);
+		if (!in.good()) {
+			out << "Unable to open file " << filename << "\n";
+			return false;
+		}
+		
+		auto takes = [&](uint32_t col) { return parser .takes (col); };
+		for (const uint8_t* p = in.beg; p != in.end; ) {
+			uint32_t col = 0;
+			auto len = lx .match (p, in.end, col, takes);
+			if (len == 0) { col = *p; len = 1; }
+			if (!parser .step_on (col, len)) break;
+			p += len;
+		}
+		parser .finish ();
+		
+		if (parser.pruned != 0) {
+			out << "Pruned " << parser.pruned << " threads to stay within a beam of " << opts.beam << ".\n";
+		}
+		
+		if (!parser.accepted() || parser.recovered != 0) {
+			size_t counted = 0, line = 1;
+			auto& errs = parser.errors;
+			for (auto e = errs.cbegin(), to = e; e != errs.cend(); e = to) {
+				to = same_position (e, errs.cend());
+				for (; counted < std::min (e->at, in.size()); ++counted) { if (in.beg [counted] == '\n') ++line; }
+				out << "Error at line " << line << ": ";
+				describe (out, *cg.afsm, lx, e, to);
+				out << "\n";
+			}
+			if (parser.recovered != 0) {
+				out << "Recovered from " << parser.recovered << " errors, skipping " << parser.skipped << " bytes.\n";
+			}
+			return false;
+		}
+		return true;
+	}
+	
+/*/// ================================================================================================================================
+	Code Generation
+	
+	A parser that ships without the generator: a header with the class, and a source with the action table and a driver.
+	The tables are static constant arrays, so a program using them does no LR construction at all. Each action is packed
+	into a word, the target above and the op in the low four bits. The conflict lists are laid end to end, with a table
+	of where each one starts.
+	
+	The driver is the one above cut down to a recognizer. There are no forests, beams, checkpoints or recovery. The stacks
+	are counted and dead nodes are kept for reuse, so memory follows the live threads and not the length of the input.
+	
+	Direct coding leaves the action table out. Each state's reductions and shifts become the cases of a switch on the
+	lookahead, and each var's gotos a switch on the state below, so the compiler picks jump tables or compares for every
+	state on its own, and a reduction goes straight to its var's switch.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	// replace every @word in text with what the word maps to
+	std::string fill (const char* text, const std::map <std::string, std::string>& words) {
+		std::string out;
+		for (auto p = text; *p != 0; ) {
+			if (*p == '@') {
+				auto q = p + 1;
+				while (isalnum ((uint8_t) *q)) ++q;
+				auto w = words .find (std::string (p + 1, q));
+				if (w != words.end()) { out .append (w->second); p = q; continue; }
+			}
+			out .push_back (*p++);
+		}
+		return out;
+	}
+	
+	const char* parser_header = R"(//
+//  @file
+//  generated by aabnf. do not edit
+//
+
+#ifndef @guard
+#define @guard
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace @ns {
+	class @cl {
+	public:
+		@cl ();
+		~@cl ();
+		
+		@cl (const @cl&) = delete;
+		@cl& operator= (const @cl&) = delete;
+		
+		// run a span through the parser. stops at the end of the span, on accepting or when every thread has died.
+		// returns where it stopped
+		const uint8_t* feed (const uint8_t* begin, const uint8_t* end);
+		
+		// no more input. true if it was accepted
+		bool finish ();
+		
+		// back to the start of the input
+		void reset ();
+		
+		inline bool   accepted () const { return accepting; }
+		inline bool   pending () const  { return !frontier.empty(); }
+		inline size_t position () const { return level; }
+		
+		// parse a whole buffer
+		static bool parse (const uint8_t* begin, const uint8_t* end);
+		
+	private:
+		struct node;
+		using nodes = std::vector <node*>;
+		
+		nodes    frontier;           // top of every live stack
+		nodes    index;              // state -> node for the frontier
+		nodes    work;               // frontier nodes whose reductions are pending
+		nodes    current;            // the frontier being shifted from
+		nodes    ends;               // where the paths of the reductions under way end
+		std::vector <std::pair <node*, node*>>    relinks;   // new links to nodes already reduced, with paths to do
+		std::vector <std::pair <node*, uint32_t>> steps;     // the paths being walked, and how far each has to go
+		nodes    dead;               // nodes being released
+		nodes    spare;              // released nodes, kept for reuse
+		size_t   level = 0;          // input position
+		uint8_t  la = 0;
+		bool     accepting = false;
+		
+		void  clear ();
+		node* make (uint32_t state);
+		void  release (node* n);
+		bool  add (uint32_t state, node* below, node** out);
+		bool  linked (node* n, node* below);
+		void  advance (uint8_t ch);
+		void  reduce_on (node* n, node* via);
+		void  reduce (node* n, uint32_t prod, node* via);
+		void  walk (node* n, uint32_t depth);
+		void  go (node* below, uint32_t var);
+		void  go_to (uint32_t state, node* below);
+		void  shift_on (node* n);
+	};
+}
+
+#endif /* @guard */
+)";
+	
+	const char* parser_driver = R"(
+	struct @cl::node {
+		stateid  state = 0;
+		size_t   refs = 0;
+		bool     reduced = false;    // all reductions on the current lookahead have been applied
+		nodes    links;              // the stacks underneath this node
+		std::vector <uint32_t> slots;   // link number + 1 by hash of the node below, once there are too many to search
+		uint32_t hashed = 0;         // links entered in slots
+	};
+	
+	@cl::@cl () : index (states, nullptr) { reset (); }
+	
+	@cl::~@cl () {
+		clear ();
+		for (auto n : spare) delete n;
+	}
+	
+	const uint8_t* @cl::feed (const uint8_t* begin, const uint8_t* end) {
+		while (begin != end && !accepting && !frontier.empty()) { advance (*begin++); }
+		return begin;
+	}
+	
+	bool @cl::finish () {
+		while (!accepting && !frontier.empty()) { advance (0xff); }
+		return accepting;
+	}
+	
+	void @cl::reset () {
+		clear ();
+		add (1, nullptr, nullptr);
+		work .clear ();
+	}
+	
+	bool @cl::parse (const uint8_t* begin, const uint8_t* end) {
+		@cl p;
+		p .feed (begin, end);
+		return p .finish ();
+	}
+	
+	void @cl::clear () {
+		for (auto n : frontier) { index [n->state] = nullptr; release (n); }
+		frontier .clear ();
+		accepting = false;
+		level = 0;
+	}
+	
+	@cl::node* @cl::make (uint32_t state) {
+		node* n;
+		if (spare.empty()) { n = new node (); }
+		else { n = spare.back(); spare .pop_back (); }
+		n->state = state;
+		n->refs = 1;
+		n->reduced = false;
+		return n;
+	}
+	
+	void @cl::release (node* n) {
+		dead .push_back (n);
+		while (!dead.empty()) {
+			auto d = dead.back(); dead .pop_back ();
+			if (--d->refs != 0) continue;
+			for (auto b : d->links) dead .push_back (b);
+			d->links .clear ();
+			d->hashed = 0;
+			spare .push_back (d);
+		}
+	}
+	
+	// the node for state on the frontier, made if need be, linked to below. false if it was linked already
+	bool @cl::add (uint32_t state, node* below, node** out) {
+		auto n = index [state];
+		if (n == nullptr) {
+			n = make (state);
+			frontier .push_back (n);
+			index [state] = n;
+			work .push_back (n);
+		}
+		else {
+			if (below == nullptr || linked (n, below)) return false;
+		}
+		
+		if (below != nullptr) { ++below->refs; n->links .push_back (below); }
+		if (out != nullptr) { *out = n; }
+		return true;
+	}
+	
+	// true when n links to below already. a node collapsing a right recursive chain gets a link for every level under
+	// it, past a few they are found through an open addressed table
+	bool @cl::linked (node* n, node* below) {
+		auto& links = n->links;
+		if (links.size() <= 8) {
+			for (auto l : links) { if (l == below) return true; }
+			return false;
+		}
+		auto& slots = n->slots;
+		if (n->hashed == 0 || slots.size() < links.size() * 2) {
+			size_t size = 16;
+			while (size < links.size() * 4) size *= 2;
+			slots .assign (size, 0);
+			n->hashed = 0;
+		}
+		size_t mask = slots.size() - 1;
+		auto slot = [&](node* b) { return (size_t) ((((uintptr_t) b) * 0x9e3779b97f4a7c15ull) >> 32) & mask; };
+		for (; n->hashed != links.size(); ++n->hashed) {
+			auto i = slot (links [n->hashed]);
+			while (slots [i] != 0) i = (i + 1) & mask;
+			slots [i] = n->hashed + 1;
+		}
+		for (auto i = slot (below); slots [i] != 0; i = (i + 1) & mask) {
+			if (links [slots [i] - 1] == below) return true;
+		}
+		return false;
+	}
+	
+	void @cl::advance (uint8_t ch) {
+		la = ch;
+		
+		// phase one - reductions, new links to reduced nodes after the nodes that are new
+		work = frontier;
+		while (!work.empty() || !relinks.empty()) {
+			if (!relinks.empty()) {
+				auto r = relinks.back(); relinks .pop_back ();
+				reduce_on (r.first, r.second);
+				continue;
+			}
+			auto n = work.back(); work .pop_back ();
+			n->reduced = true;
+			reduce_on (n, nullptr);
+		}
+		
+		// phase two - shifts and accepts
+		current .swap (frontier);
+		frontier .clear ();
+		for (auto n : current) { index [n->state] = nullptr; }
+		++level;
+		
+		for (auto n : current) { shift_on (n); }
+		for (auto n : current) { release (n); }
+		current .clear ();
+	}
+	
+	// pop the rhs along every path below n (that starts with via, if given) and goto on the var
+	void @cl::reduce (node* n, uint32_t prod, node* via) {
+		uint32_t len = pdata [prod][0], var = pdata [prod][1];
+		size_t mark = ends.size();
+		
+		if (len == 0) {
+			if (via != nullptr) return;
+			ends .push_back (n);
+		}
+		else
+		if (via != nullptr) { walk (via, len - 1); }
+		else { walk (n, len); }
+		
+		for (size_t i = mark, stop = ends.size(); i != stop; ++i) { go (ends [i], var); }
+		ends .resize (mark);
+	}
+	
+	void @cl::walk (node* n, uint32_t depth) {
+		steps .push_back ({ n, depth });
+		while (!steps.empty()) {
+			auto s = steps.back(); steps .pop_back ();
+			if (s.second == 0) { ends .push_back (s.first); continue; }
+			for (auto l = s.first->links.rbegin(); l != s.first->links.rend(); ++l) { steps .push_back ({ *l, s.second - 1 }); }
+		}
+	}
+	
+	void @cl::go_to (uint32_t state, node* below) {
+		node* n = nullptr;
+		if (add (state, below, &n) && n->reduced) {
+			// the node was already reduced. only the paths through the new link are left to do
+			relinks .push_back ({ n, below });
+		}
+	}
+	
+)";
+	
+	// the driver's reads of the action table
+	const char* parser_tabled = R"(
+	void @cl::reduce_on (node* n, node* via) {
+		auto act = action_on (n->state, la);
+		switch (act & 0xf) {
+		case 2:	reduce (n, act >> 4, via);
+					break;
+			
+		case 4:	for (auto i = conflictat [act >> 4]; i != conflictat [(act >> 4) + 1]; ++i) {
+						if ((conflicting [i] & 0xf) == 2) { reduce (n, conflicting [i] >> 4, via); }
+					}
+					break;
+		}
+	}
+	
+	void @cl::go (node* below, uint32_t var) {
+		auto next = goto_on (below->state, var);
+		if ((next & 0xf) == 3) { go_to (next >> 4, below); }
+		else
+		if ((next & 0xf) == 4) {
+			for (auto i = conflictat [next >> 4]; i != conflictat [(next >> 4) + 1]; ++i) {
+				if ((conflicting [i] & 0xf) == 3) { go_to (conflicting [i] >> 4, below); }
+			}
+		}
+	}
+	
+	void @cl::shift_on (node* n) {
+		auto act = action_on (n->state, la);
+		switch (act & 0xf) {
+		case 1:	add (act >> 4, n, nullptr);
+					break;
+			
+		case 4:	for (auto i = conflictat [act >> 4]; i != conflictat [(act >> 4) + 1]; ++i) {
+						if ((conflicting [i] & 0xf) == 1) { add (conflicting [i] >> 4, n, nullptr); }
+						else
+						if ((conflicting [i] & 0xf) == 5) { accepting = true; }
+					}
+					break;
+			
+		case 5:	accepting = true;
+					break;
+		}
+	}
+)";
+	
+	using emitcall = std::function <void(std::ostream&, action)>;
+	
+	// the cases for columns from to to of a row, one statement per action call writes. columns with the same
+	// statements share a case. false if there were none
+	bool emit_cases (std::ostream& cpp, const actionfsm& afsm, const actionrow& row, size_t from, size_t to,
+	                 const emitcall& call) {
+		std::map <std::string, std::vector <size_t>> cases;
+		std::vector <std::string> order;
+		for (auto c = from; c != to; ++c) {
+			std::stringstream ss;
+			if (row[c].op == 4) { for (auto a : afsm.conflicts [row[c].target]) call (ss, a); }
+			else { call (ss, row[c]); }
+			if (ss.str().empty()) continue;
+			auto& cols = cases [ss.str()];
+			if (cols.empty()) order .push_back (ss.str());
+			cols .push_back (c - from);
+		}
+		
+		for (auto& code : order) {
+			cpp << "\t\t\t";
+			bool sep = false;
+			for (auto c : cases [code]) { if (sep) cpp << " "; else sep = true; cpp << "case " << c << ":"; }
+			cpp << "\n" << code << "\t\t\t\tbreak;\n";
+		}
+		return !order.empty();
+	}
+	
+	// one switch per state on the lookahead, or per var on the state below, in place of reading the table
+	void emit_direct (std::ostream& cpp, const actionfsm& afsm, const std::string& name) {
+		auto each_state = [&](const char* head, const char* on, size_t from, size_t to, const emitcall& call) {
+			cpp << head;
+			cpp << "\t\tswitch (n->state) {\n";
+			for (size_t i = 0; i != afsm.states(); ++i) {
+				std::stringstream body;
+				if (!emit_cases (body, afsm, afsm.row (i), from, to, call)) continue;
+				cpp << "\t\tcase " << i << ":\n\t\t\tswitch (" << on << ") {\n" << body.str() << "\t\t\t}\n\t\t\tbreak;\n";
+			}
+			cpp << "\t\t}\n\t}\n";
+		};
+		
+		each_state ((std::string ("\n\tvoid ") + name + "::reduce_on (node* n, node* via) {\n").c_str(), "la", 0, 256,
+			[](std::ostream& out, action a) { if (a.op == 2) out << "\t\t\t\treduce (n, " << a.target << ", via);\n"; });
+		
+		each_state ((std::string ("\n\tvoid ") + name + "::shift_on (node* n) {\n").c_str(), "la", 0, 256,
+			[](std::ostream& out, action a) {
+				if (a.op == 1) out << "\t\t\t\tadd (" << a.target << ", n, nullptr);\n";
+				else
+				if (a.op == 5) out << "\t\t\t\taccepting = true;\n";
+			});
+		
+		// gotos by var first, so each reduction's var picks its switch
+		cpp << "\n\tvoid " << name << "::go (node* below, uint32_t var) {\n";
+		cpp << "\t\tswitch (var) {\n";
+		for (size_t v = 256; v != afsm.columns; ++v) {
+			std::stringstream body;
+			bool any = false;
+			for (size_t i = 0; i != afsm.states(); ++i) {
+				std::stringstream calls;
+				auto call = [&](action a) { if (a.op == 3) calls << "\t\t\t\tgo_to (" << a.target << ", below);\n"; };
+				auto a = afsm.act (i, v);
+				if (a.op == 4) { for (auto b : afsm.conflicts [a.target]) call (b); }
+				else { call (a); }
+				if (calls.str().empty()) continue;
+				body << "\t\t\tcase " << i << ":\n" << calls.str() << "\t\t\t\tbreak;\n";
+				any = true;
+			}
+			if (!any) continue;
+			cpp << "\t\tcase " << v << ":\n\t\t\tswitch (below->state) {\n" << body.str() << "\t\t\t}\n\t\t\tbreak;\n";
+		}
+		cpp << "\t\t}\n\t}\n";
+	}
+	
+	// write a parser for the compiled grammar as a header and a source. include is how the source names the header.
+	// direct codes the actions as switches, otherwise the driver reads them from a table
+	void emit (compiled& cg, const std::string& space, const std::string& name, const std::string& include,
+	           std::ostream& hpp, std::ostream& cpp, bool direct) {
+		auto& afsm = *cg.afsm;
+		
+		std::string guard;
+		for (auto c : include) { guard .push_back (isalnum ((uint8_t) c) ? c : '_'); }
+		// the narrowest state id that leaves its largest value free to mean no state
+		auto states = afsm.states();
+		const char* stateid = states < 0xff ? "uint8_t" : states < 0xffff ? "uint16_t" : "uint32_t";
+		uint32_t nobody = states < 0xff ? 0xff : states < 0xffff ? 0xffff : nostate;
+		std::map <std::string, std::string> words { { "ns", space }, { "cl", name }, { "file", include }, { "guard", guard } };
+		
+		hpp << fill (parser_header, words);
+		
+		cpp << "//\n//  generated by aabnf. do not edit\n//\n\n";
+		cpp << "#include \"" << include << "\"\n\n";
+		cpp << "namespace " << space << " {\n";
+		cpp << "\tnamespace {\n";
+		cpp << "\t\tconst size_t states  = " << states << ";\n";
+		cpp << "\t\tconst size_t columns = " << afsm.columns << ";    // 256 bytes, then the vars\n\n";
+		cpp << "\t\tusing stateid = " << stateid << ";\n\n";
+		
+		if (!direct) {
+			cpp << "\t\t// each action is its target << 4 | op. 0 error, 1 shift, 2 reduce, 3 go, 4 conflict, 5 accept\n";
+			cpp << "\t\t// the rows packed over one another, the actions on the classes of bytes, then the gotos. a row starts at its\n";
+			cpp << "\t\t// base. a cell is the state it belongs to, none when it is the largest stateid, and its action\n";
+			cpp << "\t\tconst uint32_t base [states] = {";
+			for (size_t i = 0; i != afsm.states(); ++i) { cpp << (i % 16 ? " " : "\n\t\t\t") << afsm.base[i] << ","; }
+			cpp << "\n\t\t};\n\n";
+			
+			cpp << "\t\tconst uint32_t gobase [states] = {";
+			for (size_t i = 0; i != afsm.states(); ++i) { cpp << (i % 16 ? " " : "\n\t\t\t") << afsm.gobase[i] << ","; }
+			cpp << "\n\t\t};\n\n";
+			
+			cpp << "\t\tconst stateid owner [" << afsm.cells.size() << "] = {";
+			for (size_t i = 0; i != afsm.cells.size(); ++i) {
+				cpp << (i % 16 ? " " : "\n\t\t\t") << (afsm.cells[i].state == nostate ? nobody : afsm.cells[i].state) << ",";
+			}
+			cpp << "\n\t\t};\n\n";
+			
+			cpp << "\t\tconst uint32_t acts [" << afsm.cells.size() << "] = {";
+			for (size_t i = 0; i != afsm.cells.size(); ++i) { cpp << (i % 16 ? " " : "\n\t\t\t") << packed (afsm.cells[i].act) << ","; }
+			cpp << "\n\t\t};\n\n";
+			
+			cpp << "\t\t// per state, the action on a byte it has no cell for\n";
+			cpp << "\t\tconst uint32_t defaults [states] = {";
+			for (size_t i = 0; i != afsm.states(); ++i) { cpp << (i % 16 ? " " : "\n\t\t\t") << packed (afsm.defaults[i]) << ","; }
+			cpp << "\n\t\t};\n\n";
+			
+			cpp << "\t\t// per byte, its class. bytes no terminal tells apart share one\n";
+			cpp << "\t\tconst uint8_t classof [256] = {";
+			for (size_t c = 0; c != 256; ++c) { cpp << (c % 32 ? " " : "\n\t\t\t") << afsm.colof[c] << ","; }
+			cpp << "\n\t\t};\n\n";
+			
+			cpp << "\t\tinline uint32_t action_on (stateid state, uint8_t ch) {\n";
+			cpp << "\t\t\tauto at = base [state] + classof [ch];\n";
+			cpp << "\t\t\treturn owner [at] == state ? acts [at] : defaults [state];\n";
+			cpp << "\t\t}\n\n";
+			
+			cpp << "\t\tinline uint32_t goto_on (stateid state, uint32_t var) {\n";
+			cpp << "\t\t\tauto at = gobase [state] + var - 256;\n";
+			cpp << "\t\t\treturn owner [at] == state ? acts [at] : 0;\n";
+			cpp << "\t\t}\n\n";
+			
+			auto& cs = afsm.conflicts;
+			cpp << "\t\t// where each conflict list starts in conflicting, and one past the last\n";
+			cpp << "\t\tconst uint32_t conflictat [" << cs.size() + 1 << "] = { ";
+			for (size_t i = 0; i != cs.size(); ++i) { cpp << cs.starts[i] << ","; }
+			cpp << cs.all.size() << " };\n\n";
+			
+			cpp << "\t\tconst uint32_t conflicting [" << std::max <size_t> (cs.all.size(), 1) << "] = { ";
+			bool sep = false;
+			for (auto a : cs.all) { if (sep) cpp << ","; else sep = true; cpp << packed (a); }
+			if (!sep) cpp << "0";
+			cpp << " };\n\n";
+		}
+		
+		cpp << "\t\t// per production, the states to pop and the column of its var\n";
+		cpp << "\t\tconst uint32_t pdata [" << std::max <size_t> (afsm.pdata.size(), 1) << "][2] = {\n";
+		for (auto& p : afsm.pdata) { cpp << "\t\t\t{ " << p.first << "," << p.second << " },\n"; }
+		if (afsm.pdata.empty()) cpp << "\t\t\t{ 0,0 },\n";
+		cpp << "\t\t};\n";
+		cpp << "\t}\n";
+		
+		cpp << fill (parser_driver, words);
+		if (direct) { emit_direct (cpp, afsm, name); }
+		else { cpp << fill (parser_tabled, words); }
+		cpp << "}\n";
+	}
+	
+/*/// ================================================================================================================================
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	namespace lr {
+	
+		document::document (rulesview& rv, namesview& nv) : self (new lrdocument (rv, nv)) { }
+		document::~document () { }
+		
+		bool document::load (const std::string& text) { return self->load (text); }
+		bool document::edit (size_t at, size_t erase, const std::string& insert) { return self->edit (at, erase, insert); }
+		
+		bool document::accepted () const { return self->accepted; }
+		size_t document::reparsed () const { return self->reparsed; }
+		const std::string& document::text () const { return self->text; }
+
+		void generate_from (rulesview& rv, namesview& nv, const std::string& space, const std::string& name,
+		                    const std::string& include, std::ostream& hpp, std::ostream& cpp, bool direct) {
+			auto cg = compile (rv, nv, false);
+			emit (*cg, space, name, include, hpp, cpp, direct);
+		}
+
+		bool parse_using (rulesview& rv, namesview& nv,  const char* filename, const options& opts) {
+			auto conflicts = unlexable (opts);
+			if (opts.lex && !conflicts.empty()) {
+				cout << "-lex can't be used with";
+				for (auto& c : conflicts) { cout << " " << c; }
+				cout << ", parsing without a lexer.\n";
+			}
+			
+			bool lex = opts.lex && conflicts.empty();
+			auto cg = compile (rv, nv, true, lex);
+			if (lex) {
+				lexer lx (*cg);
+				for (auto& i : lx.problems) { cout << i << "\n"; }
+				if (lx.problems.empty()) return parse_lexed (*cg, lx, filename, opts, cout);
+				cout << "The tokens can't be lexed, parsing without a lexer.\n";
+				cg = compile (rv, nv, true);
+			}
+			if (opts.ll != 0) {
+				bool used = false;
+				bool ok = parse_predictive (*cg, filename, opts, cout, used);
+				if (used) return ok;
+				cout << "The grammar is not LL(" << opts.ll << "), parsing with LR.\n";
+			}
+			if (opts.race > 1) return parse_race (*cg, filename, opts, cout);
+			if (opts.jobs > 1) return parse_split (*cg, filename, opts, cout);
+			return parse_one (*cg, filename, opts, cout);
+		}
+		
+		bool parse_with (rulesview& rv, namesview& nv, const char* filename, hooks& h, const options& opts) {
+			auto cg = compile (rv, nv, false);
+			if (h.root != 0) { h .drop (h.root); h.root = 0; }
+			
+			mapfile in (filename);
+			if (!in.good()) return false;
+			
+			lrparser parser (*cg->afsm);
+			parser .bound (opts.beam, opts.policy);
+			parser .act_with (&h);
+			parser .feed (in.beg, in.end);
+			if (!parser.finish ()) return false;
+			
+			h.root = parser .result ();
+			if (h.root != 0) { h .share (h.root); }
+			return true;
+		}
+		
+		bool parse_many (rulesview& rv, namesview& nv, const std::vector <const char*>& filenames, const options& opts) {
+			auto cg = compile (rv, nv, false);
+			return parse_each (*cg, filenames, opts);
+		}
+		
+		bool write_tables (rulesview& rv, namesview& nv, std::ostream& out) {
+			auto cg = compile (rv, nv, false);
+			return write_table (*cg->afsm, out);
+		}
+		
+		bool is_tables (const uint8_t* begin, const uint8_t* end) { return aa::is_tables (begin, end); }
+		
+		bool parse_tables (const char* tables, const std::vector <const char*>& filenames, const options& opts) {
+			auto cg = map_table (tables);
+			if (cg == nullptr) {
+				cout << "Unable to read the tables in " << tables << "\n";
+				return false;
+			}
+			if (filenames.size() > 1) return parse_each (*cg, filenames, opts);
+			
+			if (opts.lex) { cout << "-lex needs the grammar, parsing the tables without a lexer.\n"; }
+			if (opts.ll != 0) { cout << "-ll needs the grammar, parsing the tables with LR.\n"; }
+			
+			auto filename = filenames.empty() ? nullptr : filenames[0];
+			if (opts.race > 1) return parse_race (*cg, filename, opts, cout);
+			if (opts.jobs > 1) return parse_split (*cg, filename, opts, cout);
+			return parse_one (*cg, filename, opts, cout);
 		}
 	}
 
@@ -8,15 +8,159 @@
 #ifndef genparser_hpp
 #define genparser_hpp
 
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
 #include "grammar.hpp"
 
 namespace aa {
+	struct lrdocument;
+	
 	namespace lr {
 	
-		// generate a c++ class that will parse a file
-		void generate_from (rulesview& rv);
+		// how a bounded parse picks the threads that survive
+		enum class prune {
+			priority,   // fewest alternatives taken that were not first in their conflict list
+			shortest    // shortest stack
+		};
+		
+		struct options {
+			size_t   beam   = 0;                  // caps the live threads, 0 leaves the parser unbounded
+			prune    policy = prune::priority;
+			bool     forest = false;              // build a parse forest and report the derivations
+			size_t   show   = 1;                  // derivations printed from the forest
+			size_t   jobs   = 1;                  // worker threads for parse_many, or chunks of the one file for parse_using
+			size_t   race   = 0;                  // workers sharing the live threads of one parse, 0 for none
+			const char* save   = nullptr;         // stop after saveat bytes and write a checkpoint here
+			size_t   saveat = 0;
+			const char* resume = nullptr;         // carry on from this checkpoint instead of the start of the file
+			bool     recover = false;             // resynchronise after an error and report every error in one pass
+			size_t   ll     = 0;                  // parse predictively with up to this many bytes of lookahead when the grammar allows
+			bool     lex    = false;              // scan the rules named in upper case as tokens ahead of the parser
+		};
+		
+		// generate a c++ class that will parse a file, with the tables built in. the header goes to hpp and the source,
+		// which includes it by the name include, to cpp. direct codes each state as a switch instead of a table row
+		void generate_from (rulesview& rv, namesview& nv, const std::string& space, const std::string& name,
+		                    const std::string& include, std::ostream& hpp, std::ostream& cpp, bool direct = false);
+		
+		// with opts.lex set, the tokens are lexed ahead of the parser, which takes the beam and recovery options only.
+		// given with any of the others, the lexer is left out and the conflict reported.
+		// with opts.ll set, a grammar that is LL(opts.ll) is parsed predictively and the rules that aren't are reported.
+		// with opts.race above 1 the live threads are spread over that many workers, no more than there are cores, when
+		// there are enough of them to pay for it. otherwise, with opts.jobs above 1,
+		// the file is cut into chunks that are parsed speculatively on as many threads
+		bool parse_using (rulesview& rv, namesview& nv, const char* filename, const options& opts = options());
+		
+		// compile the grammar once, then parse every file on a pool of opts.jobs threads. reports each file in order.
+		// save, resume, race, ll and lex work on one target only, they are reported and left out
+		bool parse_many (rulesview& rv, namesview& nv, const std::vector <const char*>& filenames, const options& opts = options());
+		
+		// write the compiled tables of the grammar to out, binary, for parse_tables to read in place
+		bool write_tables (rulesview& rv, namesview& nv, std::ostream& out);
+		
+		// whether a buffer starts the way written tables do
+		bool is_tables (const uint8_t* begin, const uint8_t* end);
+		
+		// parse files against the tables write_tables wrote to the file tables, mapped in place instead of compiled.
+		// more than one file are parsed as parse_many does. the lex and ll options need the grammar, they are reported
+		// and left out
+		bool parse_tables (const char* tables, const std::vector <const char*>& filenames, const options& opts = options());
+		
+		// what a parse with user actions calls. a value is a slot the hooks keep, 0 for none. the slot shifted or reduced
+		// hands back carries one reference, the caller's. kids are the slots of the values the reduction popped
+		struct hooks {
+			uint32_t root = 0;     // the value of the start symbol once a parse is accepted, held until the next parse
+			
+			virtual ~hooks () { }
+			virtual uint32_t shifted (uint8_t ch, size_t at) = 0;
+			virtual uint32_t reduced (uint32_t prod, size_t from, size_t to, const uint32_t* kids, size_t count) = 0;
+			virtual void     share (uint32_t value) = 0;
+			virtual void     drop (uint32_t value) = 0;
+		};
+		
+		// typed user actions. shift makes the value of a byte and reduce the value of a production, prod being its
+		// place in the rules view, from the values of its kids over input from to to. values are moved into one
+		// buffer with room made up front and are never copied. V must be default constructible and movable.
+		// while the parse is split, one kid can be read by more than one reduction, so only move from kids where
+		// the grammar is unambiguous
+		template <typename V>
+		class actions : public hooks {
+		public:
+			// the kids of a reduction, left to right
+			struct kids {
+				actions*        self;
+				const uint32_t* at;
+				size_t          count;
+				
+				inline size_t size () const { return count; }
+				inline V& operator[] (size_t i) const { return self->values [at[i]]; }
+			};
+			
+			explicit actions (size_t room = 1024) {
+				values .reserve (room + 1); refs .reserve (room + 1);
+				values .emplace_back (); refs .push_back (0);      // slot 0 stands for no value
+			}
+			
+			V* result () { return root != 0 ? &values [root] : nullptr; }
+			
+		protected:
+			virtual V shift (uint8_t, size_t) { return V (); }
+			virtual V reduce (uint32_t prod, size_t from, size_t to, kids k) = 0;
+			
+		private:
+			std::vector <V>        values;
+			std::vector <uint32_t> refs;
+			std::vector <uint32_t> spare;      // slots free for reuse
+			
+			uint32_t put (V&& v) {
+				uint32_t at;
+				if (spare.empty()) {
+					at = (uint32_t) values.size();
+					values .push_back (std::move (v));
+					refs .push_back (1);
+				}
+				else {
+					at = spare.back(); spare .pop_back ();
+					values [at] = std::move (v);
+					refs [at] = 1;
+				}
+				return at;
+			}
+			
+			uint32_t shifted (uint8_t ch, size_t at) override { return put (shift (ch, at)); }
+			uint32_t reduced (uint32_t prod, size_t from, size_t to, const uint32_t* k, size_t count) override {
+				return put (reduce (prod, from, to, kids { this, k, count }));
+			}
+			void share (uint32_t value) override { ++refs [value]; }
+			void drop (uint32_t value) override {
+				if (--refs [value] != 0) return;
+				values [value] = V ();
+				spare .push_back (value);
+			}
+		};
+		
+		// parse a file, running h at every shift and reduction. one parser on one thread, opts.beam applies
+		bool parse_with (rulesview& rv, namesview& nv, const char* filename, hooks& h, const options& opts = options());
 		
-		bool parse_using (rulesview& rv, namesview& nv, const char* filename);
+		// a text kept parsed across edits, for editors. an edit parses again only around the change
+		class document {
+		public:
+			document (rulesview& rv, namesview& nv);
+			~document ();
+			
+			bool load (const std::string& text);
+			bool edit (size_t at, size_t erase, const std::string& insert);   // replace erase bytes at at
+			
+			bool   accepted () const;
+			size_t reparsed () const;       // bytes parsed by the last load or edit
+			const std::string& text () const;
+			
+		private:
+			std::unique_ptr <lrdocument> self;
+		};
 	};
 }
 
@@ -50,7 +50,7 @@ namespace aa {
 /*/// --------------------------------------------------------------------------------------------------------------------------------
 	literal:: literal () { }
 	literal:: literal (uchar ch) { text .push_back (ch); }
-	literal:: literal (uchar* beg, uchar* end) : text (beg, end) { }
+	literal:: literal (const uchar* beg, const uchar* end) : text (beg, end) { }
 	literal:: literal (const std::string& s) : text (s) { }
 
 	number:: number () { }
@@ -71,7 +71,7 @@ namespace aa {
 	choose:: choose () { }
 
 	rule:: rule () { }
-	rule:: rule (uchar* beg, uchar* end) : lhs (beg, end) { }
+	rule:: rule (const uchar* beg, const uchar* end) : lhs (beg, end) { }
 	rule:: rule (const std::string& s) : lhs (s) { }
 	rule:: rule (const std::string& s, term* arhs) : lhs (s), rhs (arhs) { }
 
@@ -267,8 +267,8 @@ namespace aa {
 	term* number::  copy () { return new number (*this); }
 	term* list::    copy () { return nullptr; }
 	term* mod::     copy () { return nullptr; }
-	term* range::   copy () { return nullptr; }
-	term* choose::  copy () { return nullptr; }
+	term* range::   copy () { return new range (*this); }
+	term* choose::  copy () { return new choose (*this); }
 	term* rule::    copy () { return nullptr; }
 
 
@@ -58,7 +58,7 @@ namespace aa {
 	struct literal : public term {
 		literal ();
 		literal (uchar ch);
-		literal (uchar* beg, uchar* end);
+		literal (const uchar* beg, const uchar* end);
 		literal (const std::string& s);
 		std::string text;
 
@@ -247,7 +247,7 @@ namespace aa {
 		term*       rhs;
 
 		rule ();
-		rule (uchar* beg, uchar* end);
+		rule (const uchar* beg, const uchar* end);
 		rule (const std::string& s);
 		rule (const std::string& s, term* arhs);
 
@@ -8,10 +8,14 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
 
 #include "grammar.hpp"
 #include "parser.hpp"
 #include "genparser.hpp"
+#include "mapfile.hpp"
 
 using namespace std;
 
@@ -19,37 +23,49 @@ string      spacename;
 string      classname;
 
 const char* outname   = 0;
+const char* tablesname = 0;
+bool        direct    = false;
 size_t      nextid = 0;
+aa::lr::options opts;
+vector <const char*> targets;
+size_t      editat = 0, editerase = 0;
+const char* editinsert = nullptr;
 ofstream    hout;
 ofstream    fout;
 
-using buffer = std::pair<uint8_t*, uint8_t*>;
-
-buffer read_stream_to_buf (istream& in) {
-	streamsize beg = in.tellg();
-	in .seekg (0, ios::end);
-	streamsize end = in.tellg();
-	streamsize len = end - beg;
-	in .seekg (beg, ios::beg);
-		
-	uint8_t* buf = new uint8_t [len+1];
-	in .read ((char*)buf, len);
-	buf[len] = '\0';
-	
-	return buffer (buf, buf + len);
-}
-
 void usage () {
 	cout << "AABNF Parser Generator (c) 2016\n";
-	cout << "usage: aabnf input -ns namespace -cl classname -o outputfileprefix\n";
+	cout << "usage: aabnf input -ns namespace -cl classname -o outputfileprefix -direct -tables file\n";
+	cout << "       aabnf input target... -beam n -prune policy -forest n --jobs n -race n -save file n -resume file -edit at n text -recover -ll k -lex\n";
 	cout << "where: input is the grammar file\n";
+	cout << "       without a target, a parser for the grammar is written out as c++\n";
+	cout << "       target is a file to parse with the grammar. with more than one, each is reported in turn\n";
+	cout << "       -beam caps the threads alive while parsing target\n";
+	cout << "           the default is 0, no cap\n";
+	cout << "       -prune picks the threads kept within the beam, priority or shortest\n";
+	cout << "           the default is priority, the fewest non-first conflict alternatives\n";
+	cout << "       -forest builds the parse forest, counts the derivations and prints the first n\n";
+	cout << "       --jobs parses the targets on n threads against a grammar compiled once\n";
+	cout << "           a single target is cut into n chunks that are parsed speculatively in parallel\n";
+	cout << "           the default is 1\n";
+	cout << "       -race spreads the live threads of one parse over n workers, the first to accept wins\n";
+	cout << "       -save parses the first n bytes of target, then writes the parse to a checkpoint file\n";
+	cout << "       -resume carries on parsing target from a checkpoint file\n";
+	cout << "       -edit parses target, replaces n bytes at at with text and parses again around the change\n";
+	cout << "       -recover carries on after a syntax error, so one pass reports every error\n";
+	cout << "       -ll parses predictively with up to k bytes of lookahead, up to 8, if the grammar allows\n";
+	cout << "           the rules that need more are reported and the parse falls back to LR\n";
+	cout << "       -lex scans the rules named in upper case as tokens, with a DFA ahead of the parser\n";
 	cout << "       -ns specifies the namespace in which to place abnf's output\n";
-	cout << "           the default is jig\n";
+	cout << "           the default is abnf\n";
 	cout << "       -cl specifies the class to give the parser abnf builds\n";
-	cout << "           the default is jigparser\n";
+	cout << "           the default is abnfparser\n";
 	cout << "       -o  specifies the output file abnf creates.\n";
 	cout << "           the default is 'output'\n";
-	cout << "           the h and hpp suffixes are added by bnf\n";
+	cout << "           the hpp and cpp suffixes are added by aabnf\n";
+	cout << "       -direct codes each state of the parser as a switch instead of reading a table\n";
+	cout << "       -tables writes the compiled tables to file instead of c++\n";
+	cout << "           given as input in place of a grammar, the tables are parsed against as they are\n";
 }
 
 int main(int argc, const char * argv[]) {
@@ -57,34 +73,86 @@ int main(int argc, const char * argv[]) {
 	spacename = "abnf";
 	classname = "abnfparser";
 	outname = "output";
-/*
-	int i = 2;
-	while (i < argc) {
-		if (strcmp (argv[i], "-ns") == 0) {
-			if (argc <= (i+1) || *argv[i+1] == '-') goto error;
-			spacename = argv[i+1]; i+= 2;
-		}
-		else if (strcmp (argv[i], "-cl") == 0) { 
-			if (argc <= (i+1) || *argv[i+1] == '-') goto error;
-			classname = argv[i+1]; i+= 2;
-		}
-		else if (strcmp (argv[i], "-o") == 0) {
-			if (argc <= (i+1) || *argv[i+1] == '-') goto error;
-			outname = argv[i+1]; i +=2;
-		}
-		continue;
-	error:
-		cout << "Invalid syntax near " << argv[i] << ". Ignoring parameter.\n";
-		++i;
+
+	for (int i = 2; i < argc; ++i) {
+		if (*argv[i] != '-') {
+			targets .push_back (argv[i]);
+		}
+		else if ((strcmp (argv[i], "--jobs") == 0 || strcmp (argv[i], "-jobs") == 0) && i+1 < argc) {
+			opts.jobs = strtoul (argv[i+1], nullptr, 10); ++i;
+		}
+		else if (strcmp (argv[i], "-race") == 0 && i+1 < argc) {
+			opts.race = strtoul (argv[i+1], nullptr, 10); ++i;
+		}
+		else if (strcmp (argv[i], "-save") == 0 && i+2 < argc) {
+			opts.save = argv[i+1];
+			opts.saveat = strtoul (argv[i+2], nullptr, 10); i += 2;
+		}
+		else if (strcmp (argv[i], "-edit") == 0 && i+3 < argc) {
+			editat = strtoul (argv[i+1], nullptr, 10);
+			editerase = strtoul (argv[i+2], nullptr, 10);
+			editinsert = argv[i+3]; i += 3;
+		}
+		else if (strcmp (argv[i], "-ll") == 0 && i+1 < argc) {
+			opts.ll = strtoul (argv[i+1], nullptr, 10); ++i;
+		}
+		else if (strcmp (argv[i], "-recover") == 0) {
+			opts.recover = true;
+		}
+		else if (strcmp (argv[i], "-lex") == 0) {
+			opts.lex = true;
+		}
+		else if (strcmp (argv[i], "-resume") == 0 && i+1 < argc) {
+			opts.resume = argv[i+1]; ++i;
+		}
+		else if (strcmp (argv[i], "-beam") == 0 && i+1 < argc) {
+			opts.beam = strtoul (argv[i+1], nullptr, 10); ++i;
+		}
+		else if (strcmp (argv[i], "-prune") == 0 && i+1 < argc) {
+			if (strcmp (argv[i+1], "shortest") == 0) opts.policy = aa::lr::prune::shortest;
+			else if (strcmp (argv[i+1], "priority") == 0) opts.policy = aa::lr::prune::priority;
+			else cout << "Unknown pruning policy " << argv[i+1] << ". Ignoring parameter.\n";
+			++i;
+		}
+		else if (strcmp (argv[i], "-forest") == 0 && i+1 < argc) {
+			opts.forest = true;
+			opts.show = strtoul (argv[i+1], nullptr, 10); ++i;
+		}
+		else if (strcmp (argv[i], "-ns") == 0 && i+1 < argc && *argv[i+1] != '-') {
+			spacename = argv[i+1]; ++i;
+		}
+		else if (strcmp (argv[i], "-cl") == 0 && i+1 < argc && *argv[i+1] != '-') {
+			classname = argv[i+1]; ++i;
+		}
+		else if (strcmp (argv[i], "-o") == 0 && i+1 < argc && *argv[i+1] != '-') {
+			outname = argv[i+1]; ++i;
+		}
+		else if (strcmp (argv[i], "-direct") == 0) {
+			direct = true;
+		}
+		else if (strcmp (argv[i], "-tables") == 0 && i+1 < argc) {
+			tablesname = argv[i+1]; ++i;
+		}
+		else {
+			cout << "Invalid syntax near " << argv[i] << ". Ignoring parameter.\n";
+		}
 	}
-*/	
-	ifstream in (argv[1]);
-	if (in.fail()) { cout << "Unable to open file " << argv[1] << endl; return 1; }
+	aa::mapfile in (argv[1]);
+	if (!in.good()) { cout << "Unable to open file " << argv[1] << endl; return 1; }
 	
-	auto b = read_stream_to_buf (in);
-	in .close ();
+	// written tables have no grammar to read, they are parsed against straight away
+	if (aa::lr::is_tables (in.beg, in.end)) {
+		if (targets.size() > 1) return aa::lr::parse_tables (argv[1], targets, opts) ? 0 : 1;
+		if (aa::lr::parse_tables (argv[1], targets, opts)) {
+			cout << (opts.save != nullptr ? "Parse suspended.\n" : "Successfully parsed file.\n");
+		}
+		else {
+			cout << "Could not parse file.\n";
+		}
+		return 0;
+	}
 	
-	auto g = aa::parse (b.first, b.second);
+	auto g = aa::parse (in.beg, in.end);
 	if (g != nullptr) {
 		g->dump (cout);
 		cout << "\n\n\n";
@@ -102,23 +170,51 @@ int main(int argc, const char * argv[]) {
 		}
 		
 		cout << "\n\n\n";
-//		aa::lr::generate_from (rv);
 		
-		if (aa::lr::parse_using (rv, nv, argv[2])) {
-			cout << "Successfully parsed file.\n";
+		if (targets.empty() && tablesname != nullptr) {
+			ofstream tout (tablesname, ios::binary);
+			if (!tout || !aa::lr::write_tables (rv, nv, tout)) { cout << "Unable to write " << tablesname << endl; return 1; }
+			cout << "Wrote " << tablesname << ".\n";
+		}
+		else
+		if (targets.empty()) {
+			hout .open ((string (outname) + ".hpp").c_str());
+			fout .open ((string (outname) + ".cpp").c_str());
+			if (!hout || !fout) { cout << "Unable to create " << outname << ".hpp and " << outname << ".cpp" << endl; return 1; }
+			
+			string include (outname);
+			auto slash = include .find_last_of ('/');
+			if (slash != string::npos) include .erase (0, slash + 1);
+			
+			aa::lr::generate_from (rv, nv, spacename, classname, include + ".hpp", hout, fout, direct);
+			hout .close ();
+			fout .close ();
+			cout << "Wrote " << outname << ".hpp and " << outname << ".cpp.\n";
+		}
+		else
+		if (editinsert != nullptr && targets.size() == 1) {
+			aa::mapfile t (targets[0]);
+			if (!t.good()) { cout << "Unable to open file " << targets[0] << endl; return 1; }
+			
+			aa::lr::document doc (rv, nv);
+			doc .load (string ((const char*) t.beg, t.size()));
+			cout << "Parsed " << doc.reparsed() << " bytes.\n";
+			bool ok = doc .edit (editat, editerase, editinsert);
+			cout << "The edit parsed " << doc.reparsed() << " of " << doc.text().size() << " bytes again.\n";
+			cout << (ok ? "Successfully parsed file.\n" : "Could not parse file.\n");
+		}
+		else
+		if (targets.size() > 1) {
+			if (!aa::lr::parse_many (rv, nv, targets, opts)) return 1;
+		}
+		else
+		if (aa::lr::parse_using (rv, nv, targets.empty() ? nullptr : targets[0], opts)) {
+			cout << (opts.save != nullptr ? "Parse suspended.\n" : "Successfully parsed file.\n");
 		}
 		else {
 			cout << "Could not parse file.\n";
 		}
-/*
-		hout .open ((string (outname) + ".h").c_str());
-		fout .open ((string (outname) + ".cpp").c_str());
-		
-		hout.close();
-		fout.close();
-*/
 	}
 	
-	delete[] b.first;
 	return 0;
 }
@@ -0,0 +1,111 @@
+//
+//  mapfile.hpp
+//  aabnf
+//
+//  Copyright © 2016 Theo Johnson. All rights reserved.
+//
+
+#ifndef mapfile_hpp
+#define mapfile_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace aa {
+
+/*/// ================================================================================================================================
+	A read only view of a file, mapped straight from the page cache. Nothing is copied.
+
+	The mapping is followed by at least one page of zeros, so *end is always '\0'. The grammar front end reads one
+	byte past the end of its buffer and relies on that.
+	
+	A pipe or a device can't be mapped. Those are read into a buffer instead, padded with zeros the same way.
+/*/// --------------------------------------------------------------------------------------------------------------------------------
+	struct mapfile {
+		const uint8_t* beg  = nullptr;
+		const uint8_t* end  = nullptr;
+		size_t         span = 0;         // bytes reserved, file and zero pages. 0 when the file was read instead
+		std::vector <uint8_t> copy;      // what was read, when it was
+
+		mapfile () { }
+		explicit mapfile (const char* filename) { open (filename); }
+		~mapfile () { close (); }
+
+		mapfile (const mapfile&) = delete;
+		mapfile& operator= (const mapfile&) = delete;
+
+		inline bool   good () const { return beg != nullptr; }
+		inline size_t size () const { return end - beg; }
+
+		bool open (const char* filename) {
+			close ();
+			if (filename == nullptr) return false;
+
+			int fd = ::open (filename, O_RDONLY);
+			if (fd < 0) return false;
+
+			struct stat st;
+			if (fstat (fd, &st) != 0) { ::close (fd); return false; }
+			if (!S_ISREG (st.st_mode)) return read (fd);
+
+			size_t len  = (size_t) st.st_size;
+			size_t page = (size_t) sysconf (_SC_PAGESIZE);
+			span = ((len + page - 1) / page) * page + page;
+
+			// reserve the whole span as zeros, then lay the file over the front of it
+			void* at = mmap (nullptr, span, PROT_READ, MAP_PRIVATE | MAP_ANON, -1, 0);
+			if (at == MAP_FAILED) { ::close (fd); span = 0; return false; }
+
+			if (len != 0) {
+				if (mmap (at, len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+					munmap (at, span); ::close (fd); span = 0;
+					return false;
+				}
+				madvise (at, len, MADV_SEQUENTIAL);
+			}
+			::close (fd);
+
+			beg = (const uint8_t*) at;
+			end = beg + len;
+			return true;
+		}
+
+		void close () {
+			if (span != 0) { munmap ((void*) beg, span); }
+			beg = end = nullptr;
+			span = 0;
+			copy .clear ();
+			copy .shrink_to_fit ();
+		}
+		
+	private:
+		static const size_t padding = 8;   // zeros after what was read
+		
+		// the whole of fd, to its end, into copy. closes fd
+		bool read (int fd) {
+			size_t len = 0;
+			for (;;) {
+				copy .resize (len + 65536);
+				auto got = ::read (fd, copy.data() + len, copy.size() - len);
+				if (got < 0) { ::close (fd); copy .clear (); return false; }
+				if (got == 0) break;
+				len += (size_t) got;
+			}
+			::close (fd);
+			
+			copy .resize (len);
+			copy .resize (len + padding, 0);
+			beg = copy.data();
+			end = beg + len;
+			return true;
+		}
+	};
+}
+
+#endif /* mapfile_hpp */
@@ -31,8 +31,8 @@ namespace aa {
 /*/// ================================================================================================================================
 /*/// --------------------------------------------------------------------------------------------------------------------------------
 	namespace go {
-		uchar*  nbeg = nullptr;
-		uchar*  nend = nullptr;
+		const uchar* nbeg = nullptr;
+		const uchar* nend = nullptr;
 		uint64_t num = 0;
 		
 		terms   wk;
@@ -49,8 +49,8 @@ namespace aa {
 		
 		inline uint64_t get_number () { return num; }
 		
-		bool note_beg (uchar* p) { nbeg = p; return true; }
-		bool note_end (uchar* p) { nend = p; return true; }
+		bool note_beg (const uchar* p) { nbeg = p; return true; }
+		bool note_end (const uchar* p) { nend = p; return true; }
 		
 		bool err_no_rule ()  {
 			std::cout << "No rules specified.\n";
@@ -167,8 +167,8 @@ namespace aa {
 			num = 0;
 			for (auto i = nbeg; i != nend; ++i) {
 				uint64_t n;
-				if      (*i >= 'a') { n = *i - 'a'; }
-				else if (*i >= 'A') { n = *i - 'A'; }
+				if      (*i >= 'a') { n = *i - 'a' + 10; }
+				else if (*i >= 'A') { n = *i - 'A' + 10; }
 				else                { n = *i - '0'; }
 				num = num * 16 + n;
 			}
@@ -213,9 +213,9 @@ namespace aa {
 		bool repetition ();
 
 
-		uint8_t*   pos = nullptr;
-		uint8_t*   beg = nullptr;
-		uint8_t*   end = nullptr;
+		const uint8_t* pos = nullptr;
+		const uint8_t* beg = nullptr;
+		const uint8_t* end = nullptr;
 		size_t     line = 1;
 
 		void next () {
@@ -227,7 +227,7 @@ namespace aa {
 		inline bool ch (char c) { if (*pos == c) { next(); return true; } return false; }
 		
 		inline bool str (const char* s) {
-			uint8_t* p = pos;
+			const uint8_t* p = pos;
 			while (*p == *s) {
 				++s; ++p;
 				if (*s == '\0') { pos = p; return true; }
@@ -307,7 +307,7 @@ namespace aa {
 		}
 		
 		inline bool HEXDIG() {
-			if ((*pos >= '0' && *pos < '9') || (*pos >= 'a' && *pos <= 'f') || (*pos >= 'A' && *pos <= 'F')) { next(); return true; }
+			if ((*pos >= '0' && *pos <= '9') || (*pos >= 'a' && *pos <= 'f') || (*pos >= 'A' && *pos <= 'F')) { next(); return true; }
 			return false;
 		}
 		
@@ -324,8 +324,8 @@ namespace aa {
 		}
 		
 
-		uint8_t* save () { return pos; }
-		void restore (uint8_t* apos) { pos = apos; }
+		const uint8_t* save () { return pos; }
+		void restore (const uint8_t* apos) { pos = apos; }
 
 		bool ruledef() {
 			go::note_beg (pos);
@@ -529,6 +529,9 @@ namespace aa {
 					uint64_t second = go::get_number();
 					go::range(first, second);
 				}
+				else {
+					go::range(first, first);
+				}
 				return true;
 			}
 			return false;
@@ -547,6 +550,9 @@ namespace aa {
 					uint64_t second = go::get_number();
 					go::range(first, second);
 				}
+				else {
+					go::range(first, first);
+				}
 				return true;
 			}
 			return false;
@@ -565,6 +571,9 @@ namespace aa {
 					uint64_t second = go::get_number();
 					go::range(first, second);
 				}
+				else {
+					go::range(first, first);
+				}
 				return true;
 			}
 			return false;
@@ -599,7 +608,7 @@ namespace aa {
 /*/// ================================================================================================================================
 	Entry point for parsing a buffer
 /*/// --------------------------------------------------------------------------------------------------------------------------------
-	grammar* parse (uint8_t* bufbeg, uint8_t* bufend) {
+	grammar* parse (const uint8_t* bufbeg, const uint8_t* bufend) {
 		pa::beg = bufbeg; pa::pos = bufbeg; pa::end = bufend;
 		
 		go::initialize ();
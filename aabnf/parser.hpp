@@ -11,7 +11,7 @@
 namespace aa {
 	struct grammar;
 	
-	grammar* parse (uint8_t* bufbeg, uint8_t* bufend);
+	grammar* parse (const uint8_t* bufbeg, const uint8_t* bufend);
 
 }
 
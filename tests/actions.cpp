@@ -0,0 +1,57 @@
+//
+//  actions.cpp
+//  aabnf
+//
+//  Sums the bytes of a target with lr::actions, and counts the values still held once the parse is done.
+//  usage: actions grammar target
+//
+
+#include <iostream>
+#include <memory>
+
+#include "grammar.hpp"
+#include "parser.hpp"
+#include "genparser.hpp"
+#include "mapfile.hpp"
+
+using namespace std;
+
+// every value holds a copy of tag, so tag's count less its own is the number of values alive
+shared_ptr <int> tag = make_shared <int> (0);
+
+struct sum {
+	size_t           bytes = 0;
+	shared_ptr <int> held;
+};
+
+// kids are only read, never moved from. on an ambiguous input one kid is read by every reduction over it
+class summer : public aa::lr::actions <sum> {
+protected:
+	sum shift (uint8_t, size_t) override { return sum { 1, tag }; }
+
+	sum reduce (uint32_t, size_t, size_t, kids k) override {
+		sum s { 0, tag };
+		for (size_t i = 0; i != k.size(); ++i) { s.bytes += k[i].bytes; }
+		return s;
+	}
+};
+
+int main (int argc, char** argv) {
+	if (argc != 3) { cout << "usage: actions grammar target\n"; return 1; }
+
+	aa::mapfile in (argv[1]);
+	if (!in.good()) { cout << "Unable to open file " << argv[1] << "\n"; return 1; }
+	auto g = aa::parse (in.beg, in.end);
+	if (g == nullptr) { cout << "Unable to read the grammar\n"; return 1; }
+	g->transform ();
+	auto rv = g->make_rules_view ();
+	auto nv = g->make_names_view ();
+
+	aa::mapfile t (argv[2]);
+	summer s;
+	if (!aa::lr::parse_with (rv, nv, argv[2], s) || s.result() == nullptr) { cout << "Could not parse file.\n"; return 1; }
+
+	// the result is the only value left
+	cout << s.result()->bytes << " of " << t.size() << " bytes, " << (tag.use_count() - 1) << " values held.\n";
+	return 0;
+}
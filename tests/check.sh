@@ -0,0 +1,214 @@
+#!/bin/sh
+#
+#  check.sh
+#  aabnf
+#
+#  Runs aabnf over grammars and inputs that have broken it before.
+#  usage: tests/check.sh path/to/aabnf
+#
+
+aabnf=${1:-./aabnf}
+src=$(dirname "$0")/../aabnf
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+failed=0
+
+# grammar text, lines joined with CRLF as ABNF wants
+grammar () {
+	printf '%s\r\n' "$@" > "$work/grammar"
+}
+
+# n copies of a string
+repeat () {
+	awk -v s="$1" -v n="$2" 'BEGIN { for (i = 0; i < n; ++i) printf "%s", s }'
+}
+
+# name, expected last line of output, then the arguments after the grammar and target
+expect () {
+	name=$1; want=$2; shift 2
+	got=$("$aabnf" "$work/grammar" "$work/target" "$@" 2>&1 | tail -n 1)
+	if [ "$got" = "$want" ]; then
+		echo "ok      $name"
+	else
+		echo "FAILED  $name: $(echo "$got" | cut -c 1-80)"
+		failed=1
+	fi
+}
+
+# runs with a limit of secs seconds, then got is the last line of output and took the seconds it took
+timed () {
+	secs=$1; shift
+	start=$(date +%s)
+	"$aabnf" "$work/grammar" "$work/target" "$@" > "$work/out" 2>&1 &
+	pid=$!
+	( sleep "$secs"; kill "$pid" 2> /dev/null ) &
+	watch=$!
+	wait "$pid"
+	kill "$watch" 2> /dev/null
+	took=$(( $(date +%s) - start ))
+	got=$(tail -n 1 "$work/out")
+}
+
+# like expect, but gives the run secs seconds
+within () {
+	name=$1; secs=$2; want=$3; shift 3
+	timed "$secs" "$@"
+	if [ "$got" = "$want" ]; then
+		echo "ok      $name"
+	else
+		echo "FAILED  $name: $(echo "$got" | cut -c 1-80)"
+		failed=1
+	fi
+}
+
+# right recursion collapses one stack item per reduction at the end of the input
+grammar 'start = 1*"a"'
+repeat a 40000 > "$work/target"
+expect "40 KB of a" "Successfully parsed file."
+
+# and the node the collapse ends on links to every level below it
+repeat a 1000000 > "$work/target"
+within "1 MB of a, in time" 10 "Successfully parsed file."
+
+grammar 'start = 1*("a" / "b" / "ab")'
+repeat ab 20000 > "$work/target"
+expect "40 KB of ab" "Successfully parsed file."
+expect "40 KB of ab, forest" "Successfully parsed file." -forest 0
+
+# merged threads of different lengths link to nodes in the same state, the guess for each chunk still holds
+got=$("$aabnf" "$work/grammar" "$work/target" --jobs 4 2>&1 | tail -n 2 | head -n 1)
+if [ "$got" = "Parsed in 4 chunks cut after 0x61, 0 parsed again." ]; then
+	echo "ok      --jobs 4 guesses every chunk"
+else
+	echo "FAILED  --jobs 4 guesses every chunk: $(echo "$got" | cut -c 1-80)"
+	failed=1
+fi
+
+# the byte that kills every thread is skipped along with the ones after it
+printf 'abcccab' > "$work/target"
+got=$("$aabnf" "$work/grammar" "$work/target" -recover 2>&1 | grep -a Recovered)
+if [ "$got" = "Recovered from 1 errors, skipping 3 bytes." ]; then
+	echo "ok      recovery counts the bad byte"
+else
+	echo "FAILED  recovery counts the bad byte: $got"
+	failed=1
+fi
+
+# a token that would swallow the literal after it is left to the parser
+grammar 'start = WORD "b"' 'WORD = 1*("a" / "b")'
+printf 'aab' > "$work/target"
+expect "-lex reads what the grammar reads" "Successfully parsed file." -lex
+
+grammar 'start = WORD "x" "a"' 'WORD = 1*"a"'
+printf 'aaxa' > "$work/target"
+expect "-lex reads a byte no thread takes as a token" "Successfully parsed file." -lex
+
+# racing folds the threads back together at every barrier, and leaves a parse with few threads to one worker
+grammar 'start = 1*("a" / "b" / "ab")'
+repeat ab 500000 > "$work/target"
+timed 60
+plain=$took
+timed $((plain * 2 + 5)) -race 4
+if [ "$got" = "Successfully parsed file." ] && [ "$took" -le $((plain + 1)) ]; then
+	echo "ok      -race is no slower than one parser"
+else
+	echo "FAILED  -race is no slower than one parser: ${took}s against ${plain}s, $(echo "$got" | cut -c 1-60)"
+	failed=1
+fi
+
+# an edit that leaves the stacks as they were parses only around the change
+grammar 'start = 1*("x" / "b" / "a")'
+repeat x 4000 > "$work/target"
+got=$("$aabnf" "$work/grammar" "$work/target" -edit 100 2 ba 2>&1 | grep -a "The edit")
+if [ "$got" = "The edit parsed 64 of 4000 bytes again." ]; then
+	echo "ok      -edit parses around the change"
+else
+	echo "FAILED  -edit parses around the change: $got"
+	failed=1
+fi
+
+grammar 'start = 1*("a" / "b" / "ab")'
+repeat ab 20000 > "$work/target"
+
+# a pipe can't be mapped, it is read instead
+got=$(cat "$work/target" | "$aabnf" "$work/grammar" /dev/stdin 2>&1 | tail -n 1)
+if [ "$got" = "Successfully parsed file." ]; then
+	echo "ok      target on a pipe"
+else
+	echo "FAILED  target on a pipe: $(echo "$got" | cut -c 1-80)"
+	failed=1
+fi
+
+# workers would all write the one checkpoint
+printf 'ab' > "$work/second"
+got=$("$aabnf" "$work/grammar" "$work/target" "$work/second" -save "$work/saved" 100 -race 2 2>&1 | grep -a "can't")
+if [ "$got" = "-save -race can't be used with more than one target, leaving them out." ] && [ ! -e "$work/saved" ]; then
+	echo "ok      -save with two targets is refused"
+else
+	echo "FAILED  -save with two targets is refused: $got"
+	failed=1
+fi
+
+# user actions on the parser itself. g++ takes the sources as they are with the two flags
+if ${CXX:-c++} -std=c++17 -O1 -pthread ${LIBFLAGS:--include functional -fpermissive} -I "$src" -o "$work/actions" \
+	"$(dirname "$0")/actions.cpp" "$src/genparser.cpp" "$src/grammar.cpp" "$src/parser.cpp" 2> /dev/null; then
+	actions () {
+		name=$1; want=$2
+		got=$("$work/actions" "$work/grammar" "$work/target" 2>&1 | tail -n 1)
+		if [ "$got" = "$want" ]; then
+			echo "ok      $name"
+		else
+			echo "FAILED  $name: $(echo "$got" | cut -c 1-80)"
+			failed=1
+		fi
+	}
+	# "ab" splits into one thread and two, which merge again after the b
+	grammar 'start = 1*("a" / "b" / "ab")'
+	repeat ab 2000 > "$work/target"
+	actions "actions sum an ambiguous parse" "4000 of 4000 bytes, 1 values held."
+	
+	# two rules read the same a, every reduction after the split reads one kid
+	grammar 'start = 1*(x / y / z)' 'x = "a"' 'y = "a"' 'z = "a" "b" / "b"'
+	repeat ab 2000 > "$work/target"
+	actions "actions sum across a reduce conflict" "4000 of 4000 bytes, 1 values held."
+else
+	echo "FAILED  actions: tests/actions.cpp doesn't build"
+	failed=1
+fi
+
+grammar 'start = 1*("a" / "b" / "ab")'
+repeat ab 20000 > "$work/target"
+
+# the generated parser runs the same driver
+cat > "$work/main.cpp" <<'END'
+#include "parser.hpp"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main (int, char** argv) {
+	std::ifstream in (argv[1], std::ios::binary);
+	std::string s ((std::istreambuf_iterator <char> (in)), std::istreambuf_iterator <char> ());
+	auto at = (const uint8_t*) s.data();
+	std::cout << (abnf::abnfparser::parse (at, at + s.size()) ? "Successfully parsed file." : "Could not parse file.") << "\n";
+}
+END
+
+generated () {
+	name=$1; shift
+	"$aabnf" "$work/grammar" -o "$work/parser" "$@" > /dev/null &&
+	${CXX:-c++} -std=c++11 -O1 -o "$work/parser" "$work/parser.cpp" "$work/main.cpp" &&
+	got=$("$work/parser" "$work/target" 2>&1 | tail -n 1)
+	if [ "$got" = "Successfully parsed file." ]; then
+		echo "ok      $name"
+	else
+		echo "FAILED  $name: $(echo "$got" | cut -c 1-80)"
+		failed=1
+	fi
+}
+
+generated "40 KB of ab, generated"
+generated "40 KB of ab, generated direct" -direct
+
+exit $failed